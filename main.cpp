@@ -5,10 +5,34 @@
 #include <filesystem>
 #include <limits>
 #include <string>
-#include <strings.h>
 #include <cctype>
 #include <sstream>
 #include <iomanip>
+#include <cstdint>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cmath>
+#include <cstddef>
+#include <charconv>
+#include <string_view>
+#include <utility>
+#include <array>
+#ifdef _WIN32
+#include <io.h>
+#define NOMINMAX
+#include <windows.h>
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -22,7 +46,24 @@ using namespace std;
 
 constexpr const char *DATA_FILE = "clientes.dat";
 constexpr const char *CSV_FILE = "clientes.csv";
+constexpr const char *DELTA_CSV_FILE = "clientes.csv.delta";
 constexpr size_t MAX_TEXT = 128;
+constexpr size_t REGISTROS_POR_BLOCO = 65536;
+constexpr size_t BUFFER_ESCRITA = 1 << 20;
+
+// Armazenamento particionado: DATA_FILE guarda o manifesto e cada faixa
+// de IDS_POR_SHARD IDs vive em DATA_FILE.NNNN, com cabeçalho próprio
+constexpr char MAGICA_MANIFESTO[8] = {'S', 'G', 'C', 'M', 'A', 'N', 'I', 'F'};
+constexpr char MAGICA_SHARD[8] = {'S', 'G', 'C', 'S', 'H', 'A', 'R', 'D'};
+constexpr char MAGICA_INDICE_DOCUMENTO[8] = {'S', 'G', 'C', 'D', 'O', 'C', 'I', 'X'};
+constexpr const char *SUFIXO_INDICE_DOCUMENTO = ".doc";
+constexpr char MAGICA_ORDEM_NOME[8] = {'S', 'G', 'C', 'N', 'O', 'M', 'E', 'S'};
+constexpr const char *SUFIXO_ORDEM_NOME = ".nomes";
+constexpr uint32_t VERSAO_ARMAZENAMENTO = 2; // v2: contadores resumidos após o manifesto
+constexpr uint32_t VERSAO_SEM_RESUMO = 1;
+constexpr uint32_t IDS_POR_SHARD = 65536;
+constexpr uint32_t ORDEM_POR_ID = 0;
+constexpr uint32_t ORDEM_POR_NOME = 1;
 
 struct Cliente {
     int id = 0;
@@ -37,20 +78,290 @@ struct Cliente {
     char situacao_cadastral = '\0';
 };
 
+// --------------------------------------------------------------
+// Esquema do registro
+// --------------------------------------------------------------
+
+// Tipos de campo; os códigos também são gravados no cabeçalho do binário
+// colunar
+enum class TipoCampo : uint8_t { Inteiro = 1, Curto = 2, Real = 3, Caractere = 4, Texto = 5 };
+
+// Descrição de um campo de Cliente. ESQUEMA_CLIENTE é a única descrição do
+// layout: leitura e escrita de CSV, exportação, cartão e formulário são
+// gerados a partir dela em tempo de compilação (ver "Código gerado pelo
+// esquema"). Incluir um campo é acrescentar uma linha aqui.
+struct DescritorCampo {
+    const char *nome;     // coluna no CSV e na exportação
+    TipoCampo tipo;
+    size_t deslocamento;  // offsetof(Cliente, campo)
+    size_t tamanho;       // bytes do campo (o buffer inteiro, para textos)
+    const char *pergunta; // rótulo no formulário; nullptr se não é digitado
+    const char *rotulo;   // rótulo no cartão
+    uint8_t linha_cartao;
+    uint8_t ordem_cartao; // posição do campo dentro da sua linha do cartão
+    uint8_t largura_cartao;
+    const char *dominio;  // valores aceitos pelos campos categóricos
+};
+
+constexpr DescritorCampo ESQUEMA_CLIENTE[] = {
+    {"id", TipoCampo::Inteiro, offsetof(Cliente, id), sizeof(Cliente::id), nullptr, "ID:", 0, 0, 6, nullptr},
+    {"nome_completo", TipoCampo::Texto, offsetof(Cliente, nome_completo), sizeof(Cliente::nome_completo), "Nome completo", "Nome:", 0, 1, 27, nullptr},
+    {"endereco", TipoCampo::Texto, offsetof(Cliente, endereco), sizeof(Cliente::endereco), "Endereço", "Endereço:", 3, 0, 39, nullptr},
+    {"ano_nascimento", TipoCampo::Curto, offsetof(Cliente, ano_nascimento), sizeof(Cliente::ano_nascimento), "Ano de nascimento (AAAA)", "Ano Nasc.:", 2, 2, 4, nullptr},
+    {"documento", TipoCampo::Texto, offsetof(Cliente, documento), sizeof(Cliente::documento), "CPF/CNPJ (somente números)", "Documento:", 1, 0, 14, nullptr},
+    {"tipo_cliente", TipoCampo::Caractere, offsetof(Cliente, tipo_cliente), sizeof(Cliente::tipo_cliente), "Tipo de cliente (F/J)", "Tipo:", 1, 1, 1, "FJ"},
+    {"sexo", TipoCampo::Caractere, offsetof(Cliente, sexo), sizeof(Cliente::sexo), "Sexo (M/F/O)", "Sexo:", 1, 2, 1, "MFO"},
+    {"estado_civil", TipoCampo::Caractere, offsetof(Cliente, estado_civil), sizeof(Cliente::estado_civil), "Estado civil (S/C/V/D)", "Estado Civil:", 1, 3, 1, "SCVD"},
+    {"limite_credito", TipoCampo::Real, offsetof(Cliente, limite_credito), sizeof(Cliente::limite_credito), "Limite de crédito", "Limite: R$", 2, 0, 10, nullptr},
+    {"situacao_cadastral", TipoCampo::Caractere, offsetof(Cliente, situacao_cadastral), sizeof(Cliente::situacao_cadastral), "Situação cadastral (A/I)", "Situação:", 2, 1, 1, "AI"},
+};
+constexpr size_t TOTAL_CAMPOS = sizeof(ESQUEMA_CLIENTE) / sizeof(ESQUEMA_CLIENTE[0]);
+
+// Tipo C++ de cada TipoCampo (para textos, o tipo do caractere do buffer)
+template <TipoCampo T> struct TipoNativo;
+template <> struct TipoNativo<TipoCampo::Inteiro> { using tipo = int; };
+template <> struct TipoNativo<TipoCampo::Curto> { using tipo = short; };
+template <> struct TipoNativo<TipoCampo::Real> { using tipo = float; };
+template <> struct TipoNativo<TipoCampo::Caractere> { using tipo = char; };
+template <> struct TipoNativo<TipoCampo::Texto> { using tipo = char; };
+
+constexpr bool esquema_consistente() {
+    for (size_t i = 0; i < TOTAL_CAMPOS; ++i) {
+        const DescritorCampo &d = ESQUEMA_CLIENTE[i];
+        const size_t esperado = d.tipo == TipoCampo::Inteiro ? sizeof(int)
+                                : d.tipo == TipoCampo::Curto ? sizeof(short)
+                                : d.tipo == TipoCampo::Real  ? sizeof(float)
+                                : d.tipo == TipoCampo::Caractere ? 1
+                                                                 : d.tamanho;
+        if (d.tamanho != esperado || d.deslocamento + d.tamanho > sizeof(Cliente) ||
+            (d.tipo == TipoCampo::Texto && d.tamanho < 2) || d.ordem_cartao >= TOTAL_CAMPOS) {
+            return false;
+        }
+        for (size_t j = 0; j < i; ++j) {
+            if (ESQUEMA_CLIENTE[j].linha_cartao == d.linha_cartao && ESQUEMA_CLIENTE[j].ordem_cartao == d.ordem_cartao) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+static_assert(esquema_consistente(), "ESQUEMA_CLIENTE não corresponde ao layout de Cliente");
+
+template <size_t I>
+using TipoDoCampo = typename TipoNativo<ESQUEMA_CLIENTE[I].tipo>::tipo;
+
+// Endereço do campo I; o deslocamento é constante de compilação
+template <size_t I>
+TipoDoCampo<I> *ponteiro_campo(Cliente &c) {
+    return reinterpret_cast<TipoDoCampo<I> *>(reinterpret_cast<char *>(&c) + ESQUEMA_CLIENTE[I].deslocamento);
+}
+
+template <size_t I>
+const TipoDoCampo<I> *ponteiro_campo(const Cliente &c) {
+    return reinterpret_cast<const TipoDoCampo<I> *>(reinterpret_cast<const char *>(&c) +
+                                                    ESQUEMA_CLIENTE[I].deslocamento);
+}
+
+// Chama funcao(integral_constant<size_t, I>) para cada campo, em ordem;
+// o corpo é instanciado por campo, sem despacho em tempo de execução
+template <typename Funcao, size_t... I>
+void visitar_campos(Funcao &&funcao, index_sequence<I...>) {
+    (funcao(integral_constant<size_t, I>{}), ...);
+}
+
+template <typename Funcao>
+void para_cada_campo(Funcao &&funcao) {
+    visitar_campos(funcao, make_index_sequence<TOTAL_CAMPOS>{});
+}
+
+struct CabecalhoManifesto {
+    char magica[8];
+    uint32_t versao;
+    uint32_t tamanho_registro;
+    uint32_t ids_por_shard;
+    uint32_t ordem;
+    uint64_t total_registros;
+    uint64_t total_shards;
+};
+
+// Contadores materializados da base, gravados logo após o cabeçalho do
+// manifesto (versão 2) e mantidos por deltas a cada alteração
+struct ResumoBase {
+    uint64_t total = 0;
+    uint64_t por_situacao[3] = {}; // A, I, outros
+    uint64_t por_tipo[3] = {};     // F, J, outros
+    uint64_t por_estado_civil[5] = {}; // S, C, V, D, outros
+    int64_t soma_limites_centavos = 0;
+};
+
+// Cada shard presente no disco aparece no manifesto, em ordem de índice
+struct EntradaManifesto {
+    uint64_t indice;
+    uint64_t registros;
+};
+
+struct CabecalhoShard {
+    char magica[8];
+    uint32_t versao;
+    uint32_t tamanho_registro;
+    uint64_t indice;
+    int32_t id_inicial;
+    int32_t id_final;
+    uint32_t ordem;
+    uint32_t soma_registros; // FNV-1a dos registros; 0 em shards antigos
+    uint64_t registros;
+};
+
+// Índice de documentos de um shard (DATA_FILE.NNNN.doc): pares
+// (documento, ID) ordenados por documento, regravados junto com o shard.
+// A soma copiada do cabeçalho do shard liga o índice àquela gravação.
+struct CabecalhoIndiceDocumento {
+    char magica[8];
+    uint32_t versao;
+    uint32_t tamanho_entrada;
+    uint64_t indice;
+    uint64_t registros;
+    uint32_t soma_registros;
+    uint32_t reservado;
+};
+
+struct EntradaIndiceDocumento {
+    char documento[sizeof(Cliente::documento)]; // completado com zeros
+    int32_t id;
+};
+
+// Ordem global por nome (DATA_FILE.nomes): os shards agrupam os registros
+// por faixa de ID, então a base ordenada por nome grava à parte a
+// sequência dos seus IDs, precedida deste cabeçalho
+struct CabecalhoOrdemNome {
+    char magica[8];
+    uint32_t versao;
+    uint32_t reservado;
+    uint64_t registros;
+};
+
+// Shards com registros alterados desde a última gravação
+struct EstadoShards {
+    bool *sujos = nullptr;
+    bool *em_disco = nullptr;
+    bool *documentos_em_dia = nullptr; // .doc corresponde ao shard gravado
+    size_t capacidade = 0;
+    bool todos_sujos = true; // sem manifesto lido, tudo precisa ser gravado
+    uint32_t ids_por_shard = IDS_POR_SHARD;
+    uint32_t ordem_gravada = ORDEM_POR_ID;
+};
+
+// IDs alterados desde a última atualização do espelho CSV; 'completo'
+// pede a regravação integral de clientes.csv
+struct EspelhoCsv {
+    int *pendentes = nullptr;
+    size_t quantidade = 0;
+    size_t capacidade = 0;
+    bool completo = false;
+};
+
+// Lista ordenada de IDs que contêm um trigrama (lista de postagens)
+struct ListaIds {
+    int *ids = nullptr;
+    uint32_t tamanho = 0;
+    uint32_t capacidade = 0;
+};
+
+// Índice invertido: uma lista de IDs para cada trigrama possível
+struct IndiceTrigramas {
+    ListaIds *listas = nullptr;
+};
+
+// Chave de colação do nome: níveis primário (letras sem acento e sem
+// caixa), secundário (acentos) e terciário (caixa), separados por 0x01.
+// O prefixo guarda os 8 primeiros bytes do nível primário em big-endian,
+// permitindo comparar a maioria dos pares com uma única comparação inteira.
+struct ChaveColacao {
+    uint64_t prefixo = 0;
+    string completa;
+};
+
+// Chave de colação guardada para um ID (id 0 marca posição livre)
+struct EntradaCacheColacao {
+    int id = 0;
+    ChaveColacao chave;
+};
+
+// Chaves de colação dos nomes numa tabela hash por ID (endereçamento
+// aberto), dimensionada pela quantidade de chaves e não pelo maior ID,
+// e a ordem por nome dos IDs ativos, válida até a próxima alteração
+struct CacheColacao {
+    EntradaCacheColacao *entradas = nullptr;
+    size_t capacidade = 0; // potência de 2
+    size_t usados = 0;
+    int *ordem_por_nome = nullptr;
+    size_t total_ordem = 0;
+    bool ordem_valida = false;
+};
+
+// Nó da árvore de ranking (treap com tamanho de subárvore), ordenada por
+// (limite de crédito, ID); os nós vivem em um vetor e se ligam por índice
+struct NoRanking {
+    float limite = 0.0f;
+    int id = 0;
+    uint32_t prioridade = 0;
+    int esquerda = -1;
+    int direita = -1;
+    uint32_t tamanho = 1;
+};
+
+struct ArvoreRanking {
+    NoRanking *nos = nullptr;
+    size_t capacidade = 0;
+    size_t usados = 0;
+    int raiz = -1;
+    int livre = -1; // nós liberados, encadeados pelo campo 'direita'
+};
+
+struct ChaveRanking {
+    float limite;
+    int id;
+};
+
+// Segmentos mantidos no ranking: cada um tem a sua árvore
+enum SegmentoRanking {
+    SEGMENTO_TODOS,
+    SEGMENTO_ATIVOS,
+    SEGMENTO_FISICA,
+    SEGMENTO_JURIDICA,
+    SEGMENTO_ATIVOS_FISICA,
+    SEGMENTO_ATIVOS_JURIDICA,
+    TOTAL_SEGMENTOS
+};
+
 struct BaseClientes {
     Cliente *dados = nullptr;
     size_t tamanho = 0;
     size_t capacidade = 0;
     int proximo_id = 1;
     bool solicitar_salvar = false;
+    IndiceTrigramas indice_nome;
+    IndiceTrigramas indice_endereco;
+    bool indices_suspensos = false; // cargas em lote reconstroem ao final
+    CacheColacao colacao_nome;
+    EstadoShards shards;
+    EspelhoCsv espelho_csv;
+    ResumoBase resumo;
+    ArvoreRanking ranking[TOTAL_SEGMENTOS];
 };
 
 // Declarações antecipadas
 bool salvar_clientes(BaseClientes &base, bool ordenar_por_nome = false);
 bool ha_espaco_para_salvar(const BaseClientes &base);
+bool espelho_precisa_snapshot(const BaseClientes &base);
+bool ler_arquivo_inteiro(const char *caminho, string &conteudo);
 void pausar();
-void limpar_tela();
+bool saida_e_terminal();
+void escrever_tela(const string &conteudo);
+void limpar_tela(ostream &saida);
+void desenhar_banner(ostream &saida, const string &titulo);
 void desenhar_banner(const string &titulo);
+void imprimir_cartao(ostream &saida, const Cliente &c);
 void atualizar_proximo_id(BaseClientes &base);
 int encontrar_indice_por_id(BaseClientes &base, int id);
 bool manipular_cliente(BaseClientes &base, size_t indice);
@@ -60,12 +371,33 @@ bool remover_por_indice(BaseClientes &base, size_t indice);
 bool remover_logicamente(BaseClientes &base, size_t indice);
 bool escolher_remocao(BaseClientes &base, size_t indice);
 int busca_binaria_id(const Cliente *dados, size_t quantidade, int alvo);
-int busca_binaria_nome(Cliente *dados, size_t quantidade, const string &nome);
+int busca_binaria_nome(BaseClientes &base, const string &nome);
+const ChaveColacao *obter_chave_nome(BaseClientes &base, const Cliente &c);
+const ChaveColacao *procurar_chave_colacao(const CacheColacao &cache, int id);
+void liberar_cache_colacao(CacheColacao &cache);
+void gerar_chave_colacao(const char *texto, ChaveColacao &chave);
+void descartar_chave_nome(BaseClientes &base, int id);
+bool garantir_capacidade_colacao(CacheColacao &cache, size_t nova_capacidade);
+void marcar_shard_sujo(BaseClientes &base, int id);
+void liberar_shards(EstadoShards &shards);
+void registrar_pendencia_csv(BaseClientes &base, int id);
+void contabilizar_cliente(ResumoBase &resumo, const Cliente &c, bool entrada);
+void recalcular_resumo(BaseClientes &base);
+void liberar_espelho_csv(EspelhoCsv &espelho);
 bool inserir_cliente(BaseClientes &base);
 void mostrar_trecho(BaseClientes &base, size_t ini, size_t fim);
 void submenu_ordenacao(BaseClientes &base);
 void mostrar_trecho_interativo(BaseClientes &base);
 void compactar_remocoes_logicas(BaseClientes &base);
+void reconstruir_indices(BaseClientes &base);
+void liberar_indice(IndiceTrigramas &indice);
+void registrar_insercao(BaseClientes &base, const Cliente &c);
+void registrar_atualizacao(BaseClientes &base, const Cliente &antigo, const Cliente &novo);
+void registrar_remocao(BaseClientes &base, const Cliente &c);
+void ranking_inserir(BaseClientes &base, const Cliente &c);
+void ranking_remover(BaseClientes &base, const Cliente &c);
+void reconstruir_rankings(BaseClientes &base);
+void liberar_arvore(ArvoreRanking &arvore);
 
 // --------------------------------------------------------------
 // Utilidades de entrada
@@ -112,10 +444,14 @@ float ler_float(const string &rotulo) {
     for (;;) {
         string texto = ler_linha(rotulo);
         try {
-            return stof(texto);
+            // "nan" e "inf" são aceitos por stof, mas não ordenam no ranking
+            float valor = stof(texto);
+            if (isfinite(valor)) {
+                return valor;
+            }
         } catch (...) {
-            cout << "Valor inválido. Tente novamente." << endl;
         }
+        cout << "Valor inválido. Tente novamente." << endl;
     }
 }
 
@@ -134,6 +470,50 @@ void copiar_texto(char *destino, const string &origem, size_t limite) {
     destino[limite - 1] = '\0';
 }
 
+// --------------------------------------------------------------
+// Execução paralela
+// --------------------------------------------------------------
+
+size_t quantidade_de_trabalhadores(size_t tarefas) {
+    size_t nucleos = thread::hardware_concurrency();
+    if (nucleos == 0) {
+        nucleos = 1;
+    }
+    return nucleos < tarefas ? nucleos : tarefas;
+}
+
+// Distribui as tarefas [0, quantidade) entre as threads disponíveis; cada
+// thread retira o próximo índice livre de um contador atômico
+void executar_em_paralelo(size_t quantidade, const function<void(size_t)> &tarefa) {
+    size_t trabalhadores = quantidade_de_trabalhadores(quantidade);
+    if (trabalhadores <= 1) {
+        for (size_t i = 0; i < quantidade; ++i) {
+            tarefa(i);
+        }
+        return;
+    }
+
+    atomic<size_t> proxima{0};
+    auto executar = [&]() {
+        for (size_t i = proxima++; i < quantidade; i = proxima++) {
+            tarefa(i);
+        }
+    };
+    thread *threads = new (nothrow) thread[trabalhadores - 1];
+    if (!threads) {
+        executar();
+        return;
+    }
+    for (size_t t = 0; t + 1 < trabalhadores; ++t) {
+        threads[t] = thread(executar);
+    }
+    executar();
+    for (size_t t = 0; t + 1 < trabalhadores; ++t) {
+        threads[t].join();
+    }
+    delete[] threads;
+}
+
 // --------------------------------------------------------------
 // Gerenciamento de memória dinâmica
 // --------------------------------------------------------------
@@ -143,18 +523,48 @@ void destruir_base(BaseClientes &base) {
     base.dados = nullptr;
     base.tamanho = 0;
     base.capacidade = 0;
+    liberar_indice(base.indice_nome);
+    liberar_indice(base.indice_endereco);
+    liberar_cache_colacao(base.colacao_nome);
+    liberar_shards(base.shards);
+    liberar_espelho_csv(base.espelho_csv);
+    for (size_t s = 0; s < TOTAL_SEGMENTOS; ++s) {
+        liberar_arvore(base.ranking[s]);
+    }
 }
 
-void compactar_remocoes_logicas(BaseClientes &base) {
+size_t compactar_faixa(Cliente *dados, size_t quantidade) {
     size_t destino = 0;
-    for (size_t i = 0; i < base.tamanho; ++i) {
-        if (base.dados[i].id >= 0) {
-            base.dados[destino++] = base.dados[i];
+    for (size_t i = 0; i < quantidade; ++i) {
+        if (dados[i].id >= 0) {
+            dados[destino++] = dados[i];
         }
     }
-    if (destino != base.tamanho) {
-        base.tamanho = destino;
+    return destino;
+}
+
+// Cada bloco é compactado em paralelo; em seguida os blocos são
+// aproximados sequencialmente, preservando a ordem dos registros
+void compactar_remocoes_logicas(BaseClientes &base) {
+    const size_t total_blocos = (base.tamanho + REGISTROS_POR_BLOCO - 1) / REGISTROS_POR_BLOCO;
+    size_t *mantidos = total_blocos > 1 ? new (nothrow) size_t[total_blocos] : nullptr;
+    if (!mantidos) {
+        base.tamanho = compactar_faixa(base.dados, base.tamanho);
+        return;
+    }
+
+    executar_em_paralelo(total_blocos, [&](size_t b) {
+        size_t inicio = b * REGISTROS_POR_BLOCO;
+        size_t quantidade = base.tamanho - inicio < REGISTROS_POR_BLOCO ? base.tamanho - inicio : REGISTROS_POR_BLOCO;
+        mantidos[b] = compactar_faixa(base.dados + inicio, quantidade);
+    });
+    size_t destino = mantidos[0];
+    for (size_t b = 1; b < total_blocos; ++b) {
+        memmove(base.dados + destino, base.dados + b * REGISTROS_POR_BLOCO, mantidos[b] * sizeof(Cliente));
+        destino += mantidos[b];
     }
+    base.tamanho = destino;
+    delete[] mantidos;
 }
 
 bool garantir_capacidade(BaseClientes &base, size_t nova_capacidade) {
@@ -189,10 +599,102 @@ bool garantir_capacidade(BaseClientes &base, size_t nova_capacidade) {
 }
 
 // --------------------------------------------------------------
-// Ordenação manual (Selection Sort)
+// Ordenação manual (Selection Sort e Merge Sort)
 // --------------------------------------------------------------
 
+// Merge Sort (bottom-up, estável); 'menor' compara dois itens
+template <typename T, typename Menor>
+bool ordenar_intercalando(T *itens, size_t quantidade, Menor menor) {
+    if (quantidade < 2) {
+        return true;
+    }
+    T *auxiliar = new (nothrow) T[quantidade];
+    if (!auxiliar) {
+        perror("Falha ao alocar memória para ordenação");
+        return false;
+    }
+
+    T *origem = itens;
+    T *destino = auxiliar;
+    for (size_t largura = 1; largura < quantidade; largura *= 2) {
+        for (size_t inicio = 0; inicio < quantidade; inicio += 2 * largura) {
+            size_t meio = inicio + largura < quantidade ? inicio + largura : quantidade;
+            size_t fim = inicio + 2 * largura < quantidade ? inicio + 2 * largura : quantidade;
+            size_t a = inicio;
+            size_t b = meio;
+            size_t k = inicio;
+            while (a < meio && b < fim) {
+                if (menor(origem[b], origem[a])) {
+                    destino[k++] = origem[b++];
+                } else {
+                    destino[k++] = origem[a++];
+                }
+            }
+            while (a < meio) {
+                destino[k++] = origem[a++];
+            }
+            while (b < fim) {
+                destino[k++] = origem[b++];
+            }
+        }
+        T *troca = origem;
+        origem = destino;
+        destino = troca;
+    }
+
+    if (origem != itens) {
+        for (size_t i = 0; i < quantidade; ++i) {
+            itens[i] = origem[i];
+        }
+    }
+    delete[] auxiliar;
+    return true;
+}
+
+bool ordenado_por_id(const Cliente *dados, size_t quantidade) {
+    for (size_t i = 1; i < quantidade; ++i) {
+        if (dados[i - 1].id > dados[i].id) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void ordenar_por_id(Cliente *dados, size_t quantidade) {
+    // a base quase sempre já está em ordem de ID (carga, gravação, inserção
+    // no fim); a verificação linear evita o custo quadrático nesse caso
+    if (ordenado_por_id(dados, quantidade)) {
+        return;
+    }
+
+    // fora de ordem (ex.: base gravada por nome), ordena pares (id, posição)
+    // com Merge Sort e move cada registro uma única vez; o Selection Sort
+    // fica como alternativa quando falta memória para os auxiliares
+    struct ParIdPosicao {
+        int id;
+        size_t posicao;
+    };
+    ParIdPosicao *pares = new (nothrow) ParIdPosicao[quantidade];
+    Cliente *ordenados = new (nothrow) Cliente[quantidade];
+    if (pares && ordenados) {
+        for (size_t i = 0; i < quantidade; ++i) {
+            pares[i].id = dados[i].id;
+            pares[i].posicao = i;
+        }
+        if (ordenar_intercalando(pares, quantidade,
+                                 [](const ParIdPosicao &a, const ParIdPosicao &b) { return a.id < b.id; })) {
+            for (size_t i = 0; i < quantidade; ++i) {
+                ordenados[i] = dados[pares[i].posicao];
+            }
+            memcpy(static_cast<void *>(dados), ordenados, quantidade * sizeof(Cliente));
+            delete[] pares;
+            delete[] ordenados;
+            return;
+        }
+    }
+    delete[] pares;
+    delete[] ordenados;
+
     for (size_t i = 0; i + 1 < quantidade; ++i) {
         size_t indice_min = i;
         for (size_t j = i + 1; j < quantidade; ++j) {
@@ -208,20 +710,115 @@ void ordenar_por_id(Cliente *dados, size_t quantidade) {
     }
 }
 
-void ordenar_por_nome(Cliente *dados, size_t quantidade) {
-    for (size_t i = 0; i + 1 < quantidade; ++i) {
-        size_t indice_min = i;
-        for (size_t j = i + 1; j < quantidade; ++j) {
-            if (strcmp(dados[j].nome_completo, dados[indice_min].nome_completo) < 0) {
-                indice_min = j;
+// Item ordenado no lugar do registro: só a chave em cache e a posição
+// original se movem durante a ordenação
+struct EntradaColacao {
+    uint64_t prefixo = 0;
+    const ChaveColacao *chave = nullptr;
+    size_t posicao = 0;
+};
+
+bool entrada_menor(const EntradaColacao &a, const EntradaColacao &b) {
+    if (a.prefixo != b.prefixo) {
+        return a.prefixo < b.prefixo;
+    }
+    return a.chave->completa < b.chave->completa;
+}
+
+// Monta as entradas de colação dos registros ativos, já ordenadas
+bool montar_entradas_por_nome(BaseClientes &base, EntradaColacao *entradas, size_t &quantidade) {
+    quantidade = 0;
+    // o cache é dimensionado antes para que os ponteiros das entradas não
+    // sejam invalidados por uma realocação no meio da montagem
+    if (!garantir_capacidade_colacao(base.colacao_nome, base.tamanho)) {
+        return false;
+    }
+    for (size_t i = 0; i < base.tamanho; ++i) {
+        if (base.dados[i].id <= 0) {
+            continue;
+        }
+        const ChaveColacao *chave = obter_chave_nome(base, base.dados[i]);
+        if (!chave) {
+            return false;
+        }
+        entradas[quantidade].prefixo = chave->prefixo;
+        entradas[quantidade].chave = chave;
+        entradas[quantidade++].posicao = i;
+    }
+    return ordenar_intercalando(entradas, quantidade, entrada_menor);
+}
+
+// Guarda a ordem por nome (em IDs) das entradas já ordenadas
+bool guardar_ordem_por_nome(BaseClientes &base, const EntradaColacao *entradas, size_t quantidade) {
+    CacheColacao &cache = base.colacao_nome;
+    int *ordem = new (nothrow) int[quantidade + 1];
+    if (!ordem) {
+        perror("Falha ao alocar memória para a ordem por nome");
+        return false;
+    }
+    for (size_t i = 0; i < quantidade; ++i) {
+        ordem[i] = base.dados[entradas[i].posicao].id;
+    }
+    delete[] cache.ordem_por_nome;
+    cache.ordem_por_nome = ordem;
+    cache.total_ordem = quantidade;
+    cache.ordem_valida = true;
+    return true;
+}
+
+// Remonta a ordem por nome só quando a base mudou desde a última montagem
+bool atualizar_ordem_por_nome(BaseClientes &base) {
+    if (base.colacao_nome.ordem_valida) {
+        return true;
+    }
+    EntradaColacao *entradas = new (nothrow) EntradaColacao[base.tamanho + 1];
+    if (!entradas) {
+        perror("Falha ao alocar memória para ordenação");
+        return false;
+    }
+    size_t quantidade = 0;
+    bool ok = montar_entradas_por_nome(base, entradas, quantidade) &&
+              guardar_ordem_por_nome(base, entradas, quantidade);
+    delete[] entradas;
+    return ok;
+}
+
+// Ordena a base pela colação do nome (ignorando acentos e caixa no
+// primeiro nível); os registros são movidos uma única vez ao final
+bool ordenar_por_nome(BaseClientes &base) {
+    if (base.tamanho < 2) {
+        return true;
+    }
+    EntradaColacao *entradas = new (nothrow) EntradaColacao[base.tamanho];
+    Cliente *ordenados = new (nothrow) Cliente[base.tamanho];
+    if (!entradas || !ordenados) {
+        perror("Falha ao alocar memória para ordenação");
+        delete[] entradas;
+        delete[] ordenados;
+        return false;
+    }
+
+    size_t quantidade = 0;
+    bool ok = montar_entradas_por_nome(base, entradas, quantidade) &&
+              guardar_ordem_por_nome(base, entradas, quantidade);
+    if (ok) {
+        // registros removidos logicamente (sem chave) vão para o fim
+        size_t destino = 0;
+        for (size_t i = 0; i < quantidade; ++i) {
+            ordenados[destino++] = base.dados[entradas[i].posicao];
+        }
+        for (size_t i = 0; i < base.tamanho; ++i) {
+            if (base.dados[i].id <= 0) {
+                ordenados[destino++] = base.dados[i];
             }
         }
-        if (indice_min != i) {
-            Cliente temp = dados[i];
-            dados[i] = dados[indice_min];
-            dados[indice_min] = temp;
+        for (size_t i = 0; i < base.tamanho; ++i) {
+            base.dados[i] = ordenados[i];
         }
     }
+    delete[] entradas;
+    delete[] ordenados;
+    return ok;
 }
 
 // --------------------------------------------------------------
@@ -243,24 +840,263 @@ int encontrar_indice_por_id(BaseClientes &base, int id) {
     return busca_binaria_id(base.dados, base.tamanho, id);
 }
 
+// --------------------------------------------------------------
+// Código gerado pelo esquema
+// --------------------------------------------------------------
+
+// Quantidade de caracteres (não de bytes) de um texto UTF-8
+constexpr size_t caracteres_utf8(string_view texto) {
+    size_t total = 0;
+    for (char c : texto) {
+        total += (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    }
+    return total;
+}
+
+// Copia o campo [inicio, fim) para um buffer de tamanho fixo
+void copiar_campo(char *destino, const char *inicio, const char *fim, size_t limite) {
+    size_t tamanho = static_cast<size_t>(fim - inicio);
+    if (tamanho > limite - 1) {
+        tamanho = limite - 1;
+    }
+    memcpy(destino, inicio, tamanho);
+    destino[tamanho] = '\0';
+}
+
+// Valor do campo I como texto, sem separadores (CSV, JSON e cartão)
+template <size_t I>
+void anexar_valor(string &saida, const Cliente &c) {
+    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+    const auto *valor = ponteiro_campo<I>(c);
+    if constexpr (campo.tipo == TipoCampo::Texto) {
+        saida.append(valor, strnlen(valor, campo.tamanho));
+    } else if constexpr (campo.tipo == TipoCampo::Caractere) {
+        if (*valor != '\0') {
+            saida += *valor;
+        }
+    } else {
+        char numero[64];
+        to_chars_result resultado;
+        if constexpr (campo.tipo == TipoCampo::Real) {
+            resultado = to_chars(numero, numero + sizeof(numero), static_cast<double>(*valor), chars_format::fixed, 2);
+        } else {
+            resultado = to_chars(numero, numero + sizeof(numero), *valor);
+        }
+        saida.append(numero, resultado.ptr);
+    }
+}
+
+// Interpreta [inicio, fim) como o campo I; textos são copiados em bloco
+template <size_t I>
+bool interpretar_campo(const char *inicio, const char *fim, Cliente &c) {
+    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+    auto *valor = ponteiro_campo<I>(c);
+    if constexpr (campo.tipo == TipoCampo::Texto) {
+        copiar_campo(valor, inicio, fim, campo.tamanho);
+        return true;
+    } else if constexpr (campo.tipo == TipoCampo::Caractere) {
+        *valor = inicio == fim ? '\0' : *inicio;
+        return true;
+    } else {
+        while (inicio < fim && (*inicio == ' ' || *inicio == '+')) {
+            ++inicio;
+        }
+        const from_chars_result resultado = from_chars(inicio, fim, *valor);
+        if constexpr (campo.tipo == TipoCampo::Real) {
+            if (!isfinite(*valor)) {
+                return false;
+            }
+        }
+        return resultado.ec == errc() && resultado.ptr != inicio;
+    }
+}
+
+string gerar_cabecalho_csv() {
+    string cabecalho;
+    for (size_t i = 0; i < TOTAL_CAMPOS; ++i) {
+        if (i > 0) {
+            cabecalho += ';';
+        }
+        cabecalho += ESQUEMA_CLIENTE[i].nome;
+    }
+    return cabecalho + "\n";
+}
+
+const string CABECALHO_CSV = gerar_cabecalho_csv();
+
+void formatar_linha_csv(string &saida, const Cliente &c) {
+    para_cada_campo([&](auto indice) {
+        constexpr size_t I = decltype(indice)::value;
+        if constexpr (I > 0) {
+            saida += ';';
+        }
+        anexar_valor<I>(saida, c);
+    });
+    saida += '\n';
+}
+
+// Interpreta uma linha no layout de clientes.csv, delimitada por
+// [inicio, fim). Retorna false se faltarem campos ou se algum número
+// for inválido. Com 'ignorar_id', a coluna de ID não é lida (fica 0).
+bool interpretar_linha_csv(const char *inicio, const char *fim, Cliente &cli, bool ignorar_id = false) {
+    if (fim > inicio && fim[-1] == '\r') {
+        --fim;
+    }
+    const char *campos[TOTAL_CAMPOS];
+    const char *limites[TOTAL_CAMPOS];
+    const char *cursor = inicio;
+    for (size_t k = 0; k < TOTAL_CAMPOS; ++k) {
+        const char *separador = static_cast<const char *>(memchr(cursor, ';', static_cast<size_t>(fim - cursor)));
+        if (!separador) {
+            if (k != TOTAL_CAMPOS - 1) {
+                return false;
+            }
+            separador = fim;
+        }
+        campos[k] = cursor;
+        limites[k] = separador;
+        cursor = separador < fim ? separador + 1 : fim;
+    }
+
+    cli = Cliente{};
+    bool ok = true;
+    para_cada_campo([&](auto indice) {
+        constexpr size_t I = decltype(indice)::value;
+        if constexpr (ESQUEMA_CLIENTE[I].deslocamento == offsetof(Cliente, id)) {
+            if (ignorar_id) {
+                return;
+            }
+        }
+        ok = ok && interpretar_campo<I>(campos[I], limites[I], cli);
+    });
+    return ok;
+}
+
+// Cartão: cada campo ocupa a linha 'linha_cartao', na posição
+// 'ordem_cartao', com o rótulo seguido do valor alinhado em
+// 'largura_cartao' caracteres
+constexpr size_t largura_da_linha_cartao(size_t linha) {
+    size_t largura = 0;
+    for (size_t i = 0; i < TOTAL_CAMPOS; ++i) {
+        if (ESQUEMA_CLIENTE[i].linha_cartao == linha) {
+            largura += (largura > 0 ? 1 : 0) + caracteres_utf8(ESQUEMA_CLIENTE[i].rotulo) + 1 +
+                       ESQUEMA_CLIENTE[i].largura_cartao;
+        }
+    }
+    return largura;
+}
+
+constexpr size_t contar_linhas_cartao() {
+    size_t linhas = 0;
+    for (size_t i = 0; i < TOTAL_CAMPOS; ++i) {
+        if (ESQUEMA_CLIENTE[i].linha_cartao + 1u > linhas) {
+            linhas = ESQUEMA_CLIENTE[i].linha_cartao + 1u;
+        }
+    }
+    return linhas;
+}
+
+constexpr size_t calcular_largura_cartao() {
+    size_t largura = 0;
+    for (size_t linha = 0; linha < contar_linhas_cartao(); ++linha) {
+        if (largura_da_linha_cartao(linha) > largura) {
+            largura = largura_da_linha_cartao(linha);
+        }
+    }
+    return largura;
+}
+
+constexpr size_t TOTAL_LINHAS_CARTAO = contar_linhas_cartao();
+constexpr size_t LARGURA_CARTAO = calcular_largura_cartao();
+
+void completar_com_espacos(string &saida, size_t usados, size_t largura) {
+    if (usados < largura) {
+        saida.append(largura - usados, ' ');
+    }
+}
+
+template <size_t L, size_t P>
+void montar_campo_cartao(string &saida, const Cliente &c, size_t &usados) {
+    para_cada_campo([&](auto indice) {
+        constexpr size_t I = decltype(indice)::value;
+        constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+        if constexpr (campo.linha_cartao == L && campo.ordem_cartao == P) {
+            if (usados > 0) {
+                saida += ' ';
+                usados++;
+            }
+            saida += campo.rotulo;
+            saida += ' ';
+            usados += caracteres_utf8(campo.rotulo) + 1;
+            const size_t antes = saida.size();
+            anexar_valor<I>(saida, c);
+            const size_t escritos = caracteres_utf8(string_view(saida.data() + antes, saida.size() - antes));
+            completar_com_espacos(saida, escritos, campo.largura_cartao);
+            usados += escritos > campo.largura_cartao ? escritos : campo.largura_cartao;
+        }
+    });
+}
+
+template <size_t L, size_t... P>
+void montar_linha_cartao(string &saida, const Cliente &c, index_sequence<P...>) {
+    saida += "| ";
+    size_t usados = 0;
+    (montar_campo_cartao<L, P>(saida, c, usados), ...);
+    completar_com_espacos(saida, usados, LARGURA_CARTAO);
+    saida += " |\n";
+}
+
+template <size_t... L>
+void montar_cartao(string &saida, const Cliente &c, index_sequence<L...>) {
+    (montar_linha_cartao<L>(saida, c, make_index_sequence<TOTAL_CAMPOS>{}), ...);
+}
+
+// Lê do teclado o campo I, se ele faz parte do formulário
+template <size_t I>
+void ler_campo(Cliente &c) {
+    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+    if constexpr (campo.pergunta != nullptr) {
+        auto *valor = ponteiro_campo<I>(c);
+        if constexpr (campo.tipo == TipoCampo::Texto) {
+            copiar_texto(valor, ler_linha(campo.pergunta), campo.tamanho);
+        } else if constexpr (campo.tipo == TipoCampo::Caractere) {
+            *valor = ler_char(campo.pergunta);
+        } else if constexpr (campo.tipo == TipoCampo::Real) {
+            *valor = ler_float(campo.pergunta);
+        } else if constexpr (campo.tipo == TipoCampo::Curto) {
+            *valor = ler_short(campo.pergunta);
+        } else {
+            *valor = ler_inteiro(campo.pergunta);
+        }
+    }
+}
+
+// Verdadeiro se o campo categórico I tem valor fora do seu domínio, ou se
+// o campo real I não é um número finito
+template <size_t I>
+bool fora_do_dominio(const Cliente &c) {
+    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+    if constexpr (campo.dominio != nullptr) {
+        const char valor = *ponteiro_campo<I>(c);
+        return valor == '\0' || strchr(campo.dominio, valor) == nullptr;
+    } else if constexpr (campo.tipo == TipoCampo::Real) {
+        return !isfinite(*ponteiro_campo<I>(c));
+    } else {
+        return false;
+    }
+}
+
 // --------------------------------------------------------------
 // Persistência em arquivo binário
 // --------------------------------------------------------------
 
 size_t estimar_tamanho_csv(const BaseClientes &base) {
-    const string cabecalho =
-        "id;nome_completo;endereco;ano_nascimento;documento;tipo_cliente;sexo;estado_civil;limite_credito;situacao_cadastral\n";
-
-    size_t tamanho = cabecalho.size();
+    size_t tamanho = CABECALHO_CSV.size();
+    string linha;
     for (size_t i = 0; i < base.tamanho; ++i) {
-        const Cliente &c = base.dados[i];
-        ostringstream linha;
-        linha << c.id << ';' << c.nome_completo << ';' << c.endereco << ';'
-              << c.ano_nascimento << ';' << c.documento << ';' << c.tipo_cliente
-              << ';' << c.sexo << ';' << c.estado_civil << ';' << fixed
-              << setprecision(2) << c.limite_credito << ';' << c.situacao_cadastral
-              << '\n';
-        tamanho += linha.str().size();
+        linha.clear();
+        formatar_linha_csv(linha, base.dados[i]);
+        tamanho += linha.size();
     }
     return tamanho;
 }
@@ -269,9 +1105,13 @@ bool ha_espaco_para_salvar(const BaseClientes &base) {
     try {
         namespace fs = std::filesystem;
         const auto info = fs::space(fs::current_path());
+        // o CSV completo só é estimado quando será regravado; do contrário
+        // basta o espaço das linhas anexadas ao arquivo de alterações
+        const size_t bytes_csv = espelho_precisa_snapshot(base)
+                                     ? estimar_tamanho_csv(base)
+                                     : base.espelho_csv.quantidade * sizeof(Cliente);
         const auto necessario =
-            static_cast<uintmax_t>(base.tamanho * sizeof(Cliente) +
-                                   estimar_tamanho_csv(base) + 1024); // margem
+            static_cast<uintmax_t>(base.tamanho * sizeof(Cliente) + bytes_csv + 1024); // margem
         if (info.available < necessario) {
             cerr << "Não há espaço suficiente em disco para salvar os dados." << endl;
             return false;
@@ -283,22 +1123,39 @@ bool ha_espaco_para_salvar(const BaseClientes &base) {
     return true;
 }
 
+// Exporta o CSV completo: blocos de registros são formatados em paralelo
+// e gravados em ordem
 bool salvar_csv(const BaseClientes &base) {
-    ofstream out(CSV_FILE, ios::trunc);
+    ofstream out(CSV_FILE, ios::binary | ios::trunc);
     if (!out) {
         perror("Não foi possível abrir o CSV para escrita");
         return false;
     }
+    out << CABECALHO_CSV;
 
-    out << "id;nome_completo;endereco;ano_nascimento;documento;tipo_cliente;sexo;estado_civil;limite_credito;situacao_cadastral\n";
-    out << fixed << setprecision(2);
-    for (size_t i = 0; i < base.tamanho; ++i) {
-        const Cliente &c = base.dados[i];
-        out << c.id << ';' << c.nome_completo << ';' << c.endereco << ';'
-            << c.ano_nascimento << ';' << c.documento << ';' << c.tipo_cliente
-            << ';' << c.sexo << ';' << c.estado_civil << ';' << c.limite_credito
-            << ';' << c.situacao_cadastral << "\n";
+    const size_t total_blocos = (base.tamanho + REGISTROS_POR_BLOCO - 1) / REGISTROS_POR_BLOCO;
+    const size_t por_rodada = 2 * quantidade_de_trabalhadores(total_blocos > 0 ? total_blocos : 1);
+    string *buffers = new (nothrow) string[por_rodada];
+    if (!buffers) {
+        perror("Falha ao alocar memória para o CSV");
+        return false;
     }
+    for (size_t primeiro = 0; primeiro < total_blocos && out; primeiro += por_rodada) {
+        size_t nesta_rodada = total_blocos - primeiro < por_rodada ? total_blocos - primeiro : por_rodada;
+        executar_em_paralelo(nesta_rodada, [&](size_t b) {
+            size_t inicio = (primeiro + b) * REGISTROS_POR_BLOCO;
+            size_t fim = inicio + REGISTROS_POR_BLOCO < base.tamanho ? inicio + REGISTROS_POR_BLOCO : base.tamanho;
+            buffers[b].clear();
+            for (size_t i = inicio; i < fim; ++i) {
+                formatar_linha_csv(buffers[b], base.dados[i]);
+            }
+        });
+        for (size_t b = 0; b < nesta_rodada; ++b) {
+            out.write(buffers[b].data(), static_cast<streamsize>(buffers[b].size()));
+        }
+    }
+    delete[] buffers;
+
     out.flush();
     if (!out) {
         perror("Falha ao salvar CSV");
@@ -307,297 +1164,2302 @@ bool salvar_csv(const BaseClientes &base) {
     return true;
 }
 
-bool importar_de_csv(BaseClientes &base) {
-    ifstream in(CSV_FILE);
-    if (!in) {
-        return true; // CSV opcional
-    }
+// --------------------------------------------------------------
+// Espelho CSV incremental (clientes.csv + clientes.csv.delta)
+// --------------------------------------------------------------
 
-    string linha;
-    bool primeira = true;
-    while (getline(in, linha)) {
-        bool pular_linha = false;
-        if (primeira) {
-            primeira = false;
-            if (linha.find("id;") == 0) {
-                pular_linha = true;
-            }
+// Cada linha do arquivo de alterações começa pela operação: 'U' traz o
+// registro completo (inclusão ou edição) e 'D' apenas o ID removido.
+// Aplicadas em ordem sobre clientes.csv, reproduzem a base gravada.
+constexpr const char *OPERACAO_CSV = "operacao;";
+constexpr size_t DIVISOR_CONSOLIDACAO = 4; // delta > 1/4 do CSV: regrava tudo
+
+void liberar_espelho_csv(EspelhoCsv &espelho) {
+    delete[] espelho.pendentes;
+    espelho.pendentes = nullptr;
+    espelho.quantidade = 0;
+    espelho.capacidade = 0;
+}
+
+void registrar_pendencia_csv(BaseClientes &base, int id) {
+    EspelhoCsv &espelho = base.espelho_csv;
+    if (espelho.completo || id <= 0) {
+        return;
+    }
+    // alterações em massa: regravar o CSV sai mais barato que o delta
+    const size_t limite = base.tamanho / DIVISOR_CONSOLIDACAO > 1024 ? base.tamanho / DIVISOR_CONSOLIDACAO : 1024;
+    if (espelho.quantidade >= limite) {
+        espelho.completo = true;
+        liberar_espelho_csv(espelho);
+        return;
+    }
+    if (espelho.quantidade == espelho.capacidade) {
+        size_t capacidade_alvo = espelho.capacidade == 0 ? 64 : espelho.capacidade * 2;
+        int *novos = new (nothrow) int[capacidade_alvo];
+        if (!novos) {
+            espelho.completo = true; // sem memória para a lista: regrava tudo
+            liberar_espelho_csv(espelho);
+            return;
         }
-        if (linha.empty()) {
-            pular_linha = true;
+        for (size_t i = 0; i < espelho.quantidade; ++i) {
+            novos[i] = espelho.pendentes[i];
         }
+        delete[] espelho.pendentes;
+        espelho.pendentes = novos;
+        espelho.capacidade = capacidade_alvo;
+    }
+    espelho.pendentes[espelho.quantidade++] = id;
+}
 
-        if (!pular_linha) {
-            stringstream ss(linha);
-            string campo;
-            Cliente cli{};
-
-            getline(ss, campo, ';');
-            cli.id = stoi(campo);
+uintmax_t tamanho_do_arquivo(const char *caminho) {
+    error_code erro;
+    const uintmax_t bytes = std::filesystem::file_size(caminho, erro);
+    return erro ? 0 : bytes;
+}
 
-            getline(ss, campo, ';');
-            strncpy(cli.nome_completo, campo.c_str(), MAX_TEXT - 1);
+bool espelho_precisa_snapshot(const BaseClientes &base) {
+    if (base.espelho_csv.completo || !arquivo_existe(CSV_FILE)) {
+        return true;
+    }
+    const uintmax_t delta = tamanho_do_arquivo(DELTA_CSV_FILE) + base.espelho_csv.quantidade * sizeof(Cliente);
+    return delta > tamanho_do_arquivo(CSV_FILE) / DIVISOR_CONSOLIDACAO;
+}
 
-            getline(ss, campo, ';');
-            strncpy(cli.endereco, campo.c_str(), MAX_TEXT - 1);
+// Regrava clientes.csv por inteiro e descarta o arquivo de alterações,
+// já incorporado ao novo snapshot
+bool salvar_csv_completo(BaseClientes &base) {
+    if (!salvar_csv(base)) {
+        return false;
+    }
+    if (arquivo_existe(DELTA_CSV_FILE) && remove(DELTA_CSV_FILE) != 0) {
+        perror("Não foi possível remover o arquivo de alterações do CSV");
+        return false;
+    }
+    liberar_espelho_csv(base.espelho_csv);
+    base.espelho_csv.completo = false;
+    return true;
+}
 
-            getline(ss, campo, ';');
-            cli.ano_nascimento = static_cast<short>(stoi(campo));
+// Anexa ao arquivo de alterações o estado atual de cada ID pendente
+bool gravar_delta_csv(BaseClientes &base) {
+    EspelhoCsv &espelho = base.espelho_csv;
+    if (!ordenar_intercalando(espelho.pendentes, espelho.quantidade, [](int a, int b) { return a < b; })) {
+        return false;
+    }
 
-            getline(ss, campo, ';');
-            strncpy(cli.documento, campo.c_str(), sizeof(cli.documento) - 1);
+    // a base pode estar gravada em ordem de nome: localiza pelo ID via
+    // um vetor de posições ordenado
+    size_t *ordem = nullptr;
+    const bool por_id = ordenado_por_id(base.dados, base.tamanho);
+    if (!por_id) {
+        ordem = new (nothrow) size_t[base.tamanho + 1];
+        if (!ordem) {
+            perror("Falha ao alocar memória para o CSV");
+            return false;
+        }
+        for (size_t i = 0; i < base.tamanho; ++i) {
+            ordem[i] = i;
+        }
+        const Cliente *dados = base.dados;
+        ordenar_intercalando(ordem, base.tamanho, [dados](size_t a, size_t b) { return dados[a].id < dados[b].id; });
+    }
+    auto localizar = [&](int id) -> const Cliente * {
+        size_t esquerda = 0;
+        size_t direita = base.tamanho;
+        while (esquerda < direita) {
+            size_t meio = esquerda + (direita - esquerda) / 2;
+            const Cliente &c = base.dados[por_id ? meio : ordem[meio]];
+            if (c.id < id) {
+                esquerda = meio + 1;
+            } else {
+                direita = meio;
+            }
+        }
+        if (esquerda < base.tamanho) {
+            const Cliente &c = base.dados[por_id ? esquerda : ordem[esquerda]];
+            if (c.id == id) {
+                return &c;
+            }
+        }
+        return nullptr;
+    };
 
-            getline(ss, campo, ';');
-            cli.tipo_cliente = campo.empty() ? '\0' : campo[0];
+    string conteudo;
+    const bool novo = !arquivo_existe(DELTA_CSV_FILE);
+    if (novo) {
+        conteudo += OPERACAO_CSV;
+        conteudo += CABECALHO_CSV;
+    }
+    for (size_t i = 0; i < espelho.quantidade; ++i) {
+        if (i > 0 && espelho.pendentes[i] == espelho.pendentes[i - 1]) {
+            continue;
+        }
+        const Cliente *c = localizar(espelho.pendentes[i]);
+        if (c) {
+            conteudo += "U;";
+            formatar_linha_csv(conteudo, *c);
+        } else {
+            char linha[64];
+            int n = snprintf(linha, sizeof(linha), "D;%d;;;;;;;;;\n", espelho.pendentes[i]);
+            conteudo.append(linha, static_cast<size_t>(n));
+        }
+    }
+    delete[] ordem;
 
-            getline(ss, campo, ';');
-            cli.sexo = campo.empty() ? '\0' : campo[0];
+    ofstream out(DELTA_CSV_FILE, ios::binary | ios::app);
+    if (!out) {
+        perror("Não foi possível abrir o arquivo de alterações do CSV");
+        return false;
+    }
+    out.write(conteudo.data(), static_cast<streamsize>(conteudo.size()));
+    out.flush();
+    if (!out) {
+        perror("Falha ao gravar o arquivo de alterações do CSV");
+        return false;
+    }
+    liberar_espelho_csv(espelho);
+    return true;
+}
 
-            getline(ss, campo, ';');
-            cli.estado_civil = campo.empty() ? '\0' : campo[0];
+// Mantém o espelho CSV em dia: anexa as alterações pendentes e, quando o
+// arquivo de alterações cresce demais, consolida tudo num novo snapshot
+bool atualizar_espelho_csv(BaseClientes &base) {
+    if (espelho_precisa_snapshot(base)) {
+        return salvar_csv_completo(base);
+    }
+    if (base.espelho_csv.quantidade == 0) {
+        return true;
+    }
+    return gravar_delta_csv(base);
+}
 
-            getline(ss, campo, ';');
-            cli.limite_credito = stof(campo);
+// Comando "exportar CSV completo agora": snapshot integral sob demanda
+bool exportar_csv_completo(BaseClientes &base) {
+    compactar_remocoes_logicas(base); // removidos logicamente não vão para o CSV
+    auto inicio = chrono::steady_clock::now();
+    if (!salvar_csv_completo(base)) {
+        return false;
+    }
+    chrono::duration<double> decorrido = chrono::steady_clock::now() - inicio;
+    cout << endl << base.tamanho << " registro(s) gravado(s) em " << CSV_FILE << " em " << fixed << setprecision(2)
+         << decorrido.count() << " s." << endl << endl;
+    return true;
+}
 
-            getline(ss, campo, ';');
-            cli.situacao_cadastral = campo.empty() ? '\0' : campo[0];
+struct AlteracaoCsv {
+    Cliente cliente; // em 'D', apenas o ID é preenchido
+    bool remocao;
+};
 
-            if (!garantir_capacidade(base, base.tamanho + 1)) {
+// Reaplica sobre o snapshot importado as alterações de clientes.csv.delta;
+// para cada ID vale a última alteração registrada
+bool aplicar_delta_csv(BaseClientes &base) {
+    ifstream in(DELTA_CSV_FILE);
+    if (!in) {
+        return true;
+    }
+    AlteracaoCsv *alteracoes = nullptr;
+    size_t quantidade = 0;
+    size_t capacidade = 0;
+    string linha;
+    size_t numero_linha = 0;
+    while (getline(in, linha)) {
+        ++numero_linha;
+        if (linha.size() < 2 || linha[1] != ';' || (linha[0] != 'U' && linha[0] != 'D')) {
+            continue; // cabeçalho ou linha vazia
+        }
+        AlteracaoCsv alteracao{};
+        alteracao.remocao = linha[0] == 'D';
+        if (alteracao.remocao) {
+            try {
+                alteracao.cliente.id = stoi(linha.substr(2));
+            } catch (...) {
+                alteracao.cliente.id = 0;
+            }
+        } else if (!interpretar_linha_csv(linha.data() + 2, linha.data() + linha.size(), alteracao.cliente)) {
+            alteracao.cliente.id = 0;
+        }
+        if (alteracao.cliente.id <= 0) {
+            cerr << "Linha " << numero_linha << " de " << DELTA_CSV_FILE << " ignorada: formato inválido." << endl;
+            continue;
+        }
+        if (quantidade == capacidade) {
+            size_t capacidade_alvo = capacidade == 0 ? 64 : capacidade * 2;
+            AlteracaoCsv *novas = new (nothrow) AlteracaoCsv[capacidade_alvo];
+            if (!novas) {
+                perror("Falha ao alocar memória para as alterações do CSV");
+                delete[] alteracoes;
                 return false;
             }
-            base.dados[base.tamanho++] = cli;
+            for (size_t i = 0; i < quantidade; ++i) {
+                novas[i] = alteracoes[i];
+            }
+            delete[] alteracoes;
+            alteracoes = novas;
+            capacidade = capacidade_alvo;
         }
+        alteracoes[quantidade++] = alteracao;
     }
-    atualizar_proximo_id(base);
-    return true;
-}
 
-bool carregar_clientes(BaseClientes &base) {
-    if (arquivo_existe(DATA_FILE)) {
-        ifstream in(DATA_FILE, ios::binary);
-        if (!in) {
-            perror("Não foi possível abrir o arquivo de dados");
-            return false;
+    // ordenação estável: entre alterações do mesmo ID prevalece a última
+    bool ok = ordenar_intercalando(alteracoes, quantidade, [](const AlteracaoCsv &a, const AlteracaoCsv &b) {
+        return a.cliente.id < b.cliente.id;
+    });
+    ordenar_por_id(base.dados, base.tamanho);
+    const size_t tamanho_snapshot = base.tamanho;
+    for (size_t i = 0; ok && i < quantidade; ++i) {
+        if (i + 1 < quantidade && alteracoes[i + 1].cliente.id == alteracoes[i].cliente.id) {
+            continue;
         }
-
-        Cliente temp{};
-        while (in.read(reinterpret_cast<char *>(&temp), sizeof(Cliente))) {
-            if (!garantir_capacidade(base, base.tamanho + 1)) {
-                return false;
+        const AlteracaoCsv &alteracao = alteracoes[i];
+        int pos = busca_binaria_id(base.dados, tamanho_snapshot, alteracao.cliente.id);
+        if (alteracao.remocao) {
+            if (pos >= 0) {
+                base.dados[pos].id = -base.dados[pos].id; // compactado logo abaixo
+            }
+        } else if (pos >= 0) {
+            base.dados[pos] = alteracao.cliente;
+        } else {
+            ok = garantir_capacidade(base, base.tamanho + 1);
+            if (ok) {
+                base.dados[base.tamanho++] = alteracao.cliente;
             }
-            base.dados[base.tamanho++] = temp;
         }
-        atualizar_proximo_id(base);
-        return true;
     }
-
-    if (!importar_de_csv(base)) {
+    delete[] alteracoes;
+    if (!ok) {
         return false;
     }
-
-    if (base.tamanho == 0) {
-        return true;
-    }
-
-    return salvar_clientes(base);
+    compactar_remocoes_logicas(base);
+    ordenar_por_id(base.dados, base.tamanho);
+    return true;
 }
 
-bool salvar_clientes(BaseClientes &base, bool ordenar_por_nome_flag) {
-    compactar_remocoes_logicas(base);
-    if (ordenar_por_nome_flag) {
-        ordenar_por_nome(base.dados, base.tamanho);
-    } else {
-        ordenar_por_id(base.dados, base.tamanho);
+// O arquivo é lido de uma vez e as linhas são interpretadas direto no
+// buffer; a base é dimensionada uma única vez pela contagem de linhas
+bool importar_de_csv(BaseClientes &base) {
+    if (!arquivo_existe(CSV_FILE)) {
+        return true; // CSV opcional
     }
-
-    if (!ha_espaco_para_salvar(base)) {
+    string conteudo;
+    if (!ler_arquivo_inteiro(CSV_FILE, conteudo)) {
         return false;
     }
 
-    ofstream out(DATA_FILE, ios::binary | ios::trunc);
-    if (!out) {
-        perror("Não foi possível abrir o arquivo de dados");
+    const char *cursor = conteudo.data();
+    const char *final_arquivo = cursor + conteudo.size();
+    size_t linhas = 1;
+    for (const char *p = cursor; (p = static_cast<const char *>(memchr(p, '\n', static_cast<size_t>(final_arquivo - p))));
+         ++p) {
+        ++linhas;
+    }
+    if (!garantir_capacidade(base, base.tamanho + linhas)) {
         return false;
     }
 
-    for (size_t i = 0; i < base.tamanho; ++i) {
-        out.write(reinterpret_cast<const char *>(&base.dados[i]), sizeof(Cliente));
-        if (!out) {
-            perror("Falha ao salvar dados");
-            return false;
+    size_t numero_linha = 0;
+    while (cursor < final_arquivo) {
+        const char *fim = static_cast<const char *>(memchr(cursor, '\n', static_cast<size_t>(final_arquivo - cursor)));
+        if (!fim) {
+            fim = final_arquivo;
         }
+        ++numero_linha;
+        const bool cabecalho = numero_linha == 1 && fim - cursor >= 3 && memcmp(cursor, "id;", 3) == 0;
+        const bool vazia = fim == cursor || (fim - cursor == 1 && *cursor == '\r');
+        if (!cabecalho && !vazia) {
+            if (interpretar_linha_csv(cursor, fim, base.dados[base.tamanho])) {
+                base.tamanho++;
+            } else {
+                cerr << "Linha " << numero_linha << " do CSV ignorada: formato inválido." << endl;
+            }
+        }
+        cursor = fim + 1;
     }
-    out.flush();
-    if (!out) {
-        perror("Falha ao salvar dados");
+    if (!aplicar_delta_csv(base)) {
         return false;
     }
     atualizar_proximo_id(base);
-    return salvar_csv(base);
+    return true;
 }
 
 // --------------------------------------------------------------
-// Operações de busca (binária)
+// Arquivos de dados particionados (shards por faixa de ID)
 // --------------------------------------------------------------
 
-int busca_binaria_id(const Cliente *dados, size_t quantidade, int alvo) {
-    size_t inicio = 0;
-    size_t fim = quantidade;
-    while (inicio < fim) {
-        size_t meio = inicio + (fim - inicio) / 2;
-        if (dados[meio].id == alvo) {
-            return static_cast<int>(meio);
-        }
-        if (dados[meio].id < alvo) {
-            inicio = meio + 1;
-        } else {
-            fim = meio;
-        }
-    }
-    return -1;
+size_t shard_do_id(int id, uint32_t ids_por_shard) {
+    size_t absoluto = static_cast<size_t>(id < 0 ? -static_cast<long long>(id) : id);
+    return absoluto == 0 ? 0 : (absoluto - 1) / ids_por_shard;
 }
 
-int busca_binaria_nome(Cliente *dados, size_t quantidade, const string &nome) {
-    ordenar_por_nome(dados, quantidade);
+string caminho_do_shard(size_t indice) {
+    char sufixo[32];
+    snprintf(sufixo, sizeof(sufixo), ".%04zu", indice);
+    return string(DATA_FILE) + sufixo;
+}
 
-    size_t inicio = 0;
-    size_t fim = quantidade;
-    while (inicio < fim) {
-        size_t meio = inicio + (fim - inicio) / 2;
-        int comparacao = strcasecmp(dados[meio].nome_completo, nome.c_str());
-        if (comparacao == 0) {
-            return static_cast<int>(meio);
-        }
-        if (comparacao < 0) {
-            inicio = meio + 1;
-        } else {
-            fim = meio;
-        }
+bool garantir_capacidade_shards(EstadoShards &shards, size_t nova_capacidade) {
+    if (nova_capacidade <= shards.capacidade) {
+        return true;
     }
-    return -1;
+    size_t capacidade_alvo = shards.capacidade == 0 ? 16 : shards.capacidade;
+    while (capacidade_alvo < nova_capacidade) {
+        capacidade_alvo *= 2;
+    }
+    bool *sujos = new (nothrow) bool[capacidade_alvo]();
+    bool *em_disco = new (nothrow) bool[capacidade_alvo]();
+    bool *documentos_em_dia = new (nothrow) bool[capacidade_alvo]();
+    if (!sujos || !em_disco || !documentos_em_dia) {
+        perror("Falha ao alocar memória para o controle de shards");
+        delete[] sujos;
+        delete[] em_disco;
+        delete[] documentos_em_dia;
+        return false;
+    }
+    for (size_t i = 0; i < shards.capacidade; ++i) {
+        sujos[i] = shards.sujos[i];
+        em_disco[i] = shards.em_disco[i];
+        documentos_em_dia[i] = shards.documentos_em_dia[i];
+    }
+    delete[] shards.sujos;
+    delete[] shards.em_disco;
+    delete[] shards.documentos_em_dia;
+    shards.sujos = sujos;
+    shards.em_disco = em_disco;
+    shards.documentos_em_dia = documentos_em_dia;
+    shards.capacidade = capacidade_alvo;
+    return true;
 }
 
-// --------------------------------------------------------------
-// CRUD
-// --------------------------------------------------------------
-
-bool existe_documento(const BaseClientes &base, const string &documento) {
-    for (size_t i = 0; i < base.tamanho; ++i) {
-        if (documento == base.dados[i].documento) {
-            return true;
-        }
+void marcar_shard_sujo(BaseClientes &base, int id) {
+    size_t indice = shard_do_id(id, base.shards.ids_por_shard);
+    if (garantir_capacidade_shards(base.shards, indice + 1)) {
+        base.shards.sujos[indice] = true;
+    } else {
+        base.shards.todos_sujos = true;
     }
-    return false;
 }
 
-Cliente ler_dados_cliente(int id_atribuido) {
-    Cliente c;
-    c.id = id_atribuido;
-    string nome = ler_linha("Nome completo");
-    string endereco = ler_linha("Endereço");
-    string documento = ler_linha("CPF/CNPJ (somente números)");
-    c.ano_nascimento = ler_short("Ano de nascimento (AAAA)");
-    c.tipo_cliente = ler_char("Tipo de cliente (F/J)");
-    c.sexo = ler_char("Sexo (M/F/O)");
-    c.estado_civil = ler_char("Estado civil (S/C/V/D)");
-    c.limite_credito = ler_float("Limite de crédito");
-    c.situacao_cadastral = ler_char("Situação cadastral (A/I)");
-
-    copiar_texto(c.nome_completo, nome, MAX_TEXT);
-    copiar_texto(c.endereco, endereco, MAX_TEXT);
-    copiar_texto(c.documento, documento, sizeof(c.documento));
-    return c;
+void liberar_shards(EstadoShards &shards) {
+    delete[] shards.sujos;
+    delete[] shards.em_disco;
+    delete[] shards.documentos_em_dia;
+    shards.sujos = nullptr;
+    shards.em_disco = nullptr;
+    shards.documentos_em_dia = nullptr;
+    shards.capacidade = 0;
 }
 
-void imprimir_cartao(const Cliente &c) {
-    cout << "+------------------------------------------------+" << endl;
-    cout << "| ID: " << setw(6) << left << c.id << " Nome: " << setw(27) << left << c.nome_completo << "|" << endl;
-    cout << "| Documento: " << setw(14) << left << c.documento << " Tipo: " << setw(1) << left << c.tipo_cliente
-         << " Sexo: " << setw(1) << left << c.sexo << " Estado Civil: " << setw(1) << left << c.estado_civil << "             |" << endl;
-    cout << "| Limite: R$ " << setw(10) << left << fixed << setprecision(2) << c.limite_credito
-         << " Situação: " << setw(1) << left << c.situacao_cadastral << " Ano Nasc.: " << setw(4) << left << c.ano_nascimento << "      |" << endl;
-    cout << "| Endereço: " << setw(39) << left << c.endereco << "|" << endl;
-    cout << "+------------------------------------------------+" << endl << endl;
+bool ler_cabecalho_manifesto(ifstream &in, CabecalhoManifesto &cabecalho) {
+    if (!in.read(reinterpret_cast<char *>(&cabecalho), sizeof(cabecalho))) {
+        return false;
+    }
+    return memcmp(cabecalho.magica, MAGICA_MANIFESTO, sizeof(MAGICA_MANIFESTO)) == 0;
 }
 
-void mostrar_trecho(BaseClientes &base, size_t ini, size_t fim) {
-    if (base.tamanho == 0) {
-        cout << "Nenhum cliente cadastrado ainda." << endl << endl;
+// Reordena a base carregada pela sequência de IDs de DATA_FILE.nomes; se
+// o arquivo faltar ou não corresponder aos shards (gravação interrompida),
+// a base fica em ordem de ID
+void restaurar_ordem_por_nome(BaseClientes &base) {
+    ifstream in(string(DATA_FILE) + SUFIXO_ORDEM_NOME, ios::binary);
+    CabecalhoOrdemNome cab{};
+    if (!in.read(reinterpret_cast<char *>(&cab), sizeof(cab)) ||
+        memcmp(cab.magica, MAGICA_ORDEM_NOME, sizeof(MAGICA_ORDEM_NOME)) != 0 || cab.registros != base.tamanho) {
+        cerr << "Aviso: ordem por nome não encontrada; base carregada em ordem de ID." << endl;
         return;
     }
-
-    if (ini == 0 || ini > fim || fim > base.tamanho) {
-        cout << "Range inválido." << endl << endl;
-        return;
+    int32_t *ids = new (nothrow) int32_t[base.tamanho + 1];
+    Cliente *ordenados = new (nothrow) Cliente[base.tamanho + 1];
+    bool *usados = new (nothrow) bool[base.tamanho + 1]();
+    bool ok = ids && ordenados && usados &&
+              in.read(reinterpret_cast<char *>(ids), static_cast<streamsize>(base.tamanho * sizeof(int32_t)));
+    if (ok) {
+        ordenar_por_id(base.dados, base.tamanho);
+        for (size_t i = 0; ok && i < base.tamanho; ++i) {
+            int posicao = busca_binaria_id(base.dados, base.tamanho, ids[i]);
+            ok = posicao >= 0 && !usados[posicao];
+            if (ok) {
+                usados[posicao] = true;
+                ordenados[i] = base.dados[posicao];
+            }
+        }
     }
-
-    cout << "Mostrando registros " << ini << " a " << fim << " de " << base.tamanho << endl << endl;
-    for (size_t i = ini - 1; i < fim; ++i) {
-        imprimir_cartao(base.dados[i]);
+    if (ok) {
+        for (size_t i = 0; i < base.tamanho; ++i) {
+            base.dados[i] = ordenados[i];
+        }
+    } else {
+        cerr << "Aviso: ordem por nome desatualizada; base carregada em ordem de ID." << endl;
     }
+    delete[] ids;
+    delete[] ordenados;
+    delete[] usados;
 }
 
-void listar_clientes(BaseClientes &base) {
-    desenhar_banner("Clientes cadastrados");
+// Verdadeiro se o índice de documentos do shard corresponde à gravação
+// descrita pelo cabeçalho do shard (mesma soma e mesma quantidade)
+bool indice_de_documentos_atualizado(const CabecalhoShard &cab_shard) {
+    ifstream doc(caminho_do_shard(cab_shard.indice) + SUFIXO_INDICE_DOCUMENTO, ios::binary);
+    CabecalhoIndiceDocumento cab_doc{};
+    return doc.read(reinterpret_cast<char *>(&cab_doc), sizeof(cab_doc)) &&
+           memcmp(cab_doc.magica, MAGICA_INDICE_DOCUMENTO, sizeof(MAGICA_INDICE_DOCUMENTO)) == 0 &&
+           cab_doc.tamanho_entrada == sizeof(EntradaIndiceDocumento) && cab_doc.indice == cab_shard.indice &&
+           cab_shard.soma_registros != 0 && cab_doc.soma_registros == cab_shard.soma_registros &&
+           cab_doc.registros == cab_shard.registros;
+}
 
-    if (base.tamanho == 0) {
-        cout << "Nenhum cliente cadastrado ainda." << endl << endl;
-        return;
+// Lê o manifesto e os shards listados: os cabeçalhos são lidos primeiro
+// para dimensionar a base uma única vez; depois cada shard é lido em
+// paralelo diretamente para sua faixa do vetor
+bool carregar_shards(BaseClientes &base) {
+    ifstream manifesto(DATA_FILE, ios::binary);
+    CabecalhoManifesto cabecalho{};
+    if (!ler_cabecalho_manifesto(manifesto, cabecalho)) {
+        cerr << "Manifesto " << DATA_FILE << " inválido." << endl;
+        return false;
     }
+    if (cabecalho.versao < VERSAO_SEM_RESUMO || cabecalho.versao > VERSAO_ARMAZENAMENTO ||
+        cabecalho.tamanho_registro != sizeof(Cliente) || cabecalho.ids_por_shard == 0) {
+        cerr << "Formato de " << DATA_FILE << " incompatível com esta versão do programa." << endl;
+        return false;
+    }
+    // manifestos da versão 1 não trazem os contadores: recalculados ao final
+    bool resumo_lido = cabecalho.versao >= 2 &&
+                       static_cast<bool>(manifesto.read(reinterpret_cast<char *>(&base.resumo), sizeof(ResumoBase)));
 
-    ordenar_por_id(base.dados, base.tamanho);
-    const size_t por_pagina = 10;
-    size_t indice = 0;
-
-    while (indice < base.tamanho) {
-        size_t ate = indice + por_pagina;
-        if (ate > base.tamanho) {
-            ate = base.tamanho;
-        }
+    const size_t total = static_cast<size_t>(cabecalho.total_shards);
+    EntradaManifesto *entradas = new (nothrow) EntradaManifesto[total + 1];
+    size_t *deslocamentos = new (nothrow) size_t[total + 1];
+    if (!entradas || !deslocamentos) {
+        perror("Falha ao alocar memória para o manifesto");
+        delete[] entradas;
+        delete[] deslocamentos;
+        return false;
+    }
+    bool ok = !total || static_cast<bool>(manifesto.read(reinterpret_cast<char *>(entradas),
+                                                        static_cast<streamsize>(total * sizeof(EntradaManifesto))));
+    if (!ok) {
+        cerr << "Manifesto " << DATA_FILE << " truncado." << endl;
+    }
+    ok = ok &&
+         garantir_capacidade_shards(base.shards, total > 0 ? static_cast<size_t>(entradas[total - 1].indice) + 1 : 1);
 
-        cout << "Mostrando registros " << (indice + 1) << " a " << ate << " de " << base.tamanho << endl << endl;
-        for (size_t i = indice; i < ate; ++i) {
-            imprimir_cartao(base.dados[i]);
+    // os cabeçalhos dos shards prevalecem sobre as contagens do manifesto;
+    // um shard listado com zero registros que já não existe (gravação
+    // interrompida) é apenas ignorado. Cada cabeçalho lido também diz se o
+    // índice de documentos do shard está em dia, o que poupa a gravação de
+    // reabrir os dois arquivos a cada salvamento.
+    size_t registros = 0;
+    for (size_t s = 0; ok && s < total; ++s) {
+        ifstream in(caminho_do_shard(entradas[s].indice), ios::binary);
+        CabecalhoShard cab{};
+        deslocamentos[s] = registros;
+        if (!in.read(reinterpret_cast<char *>(&cab), sizeof(cab)) ||
+            memcmp(cab.magica, MAGICA_SHARD, sizeof(MAGICA_SHARD)) != 0 || cab.indice != entradas[s].indice ||
+            cab.tamanho_registro != sizeof(Cliente)) {
+            if (entradas[s].registros == 0) {
+                continue;
+            }
+            cerr << "Shard " << caminho_do_shard(entradas[s].indice) << " ausente ou inválido." << endl;
+            ok = false;
+            break;
         }
+        entradas[s].registros = cab.registros;
+        registros += static_cast<size_t>(cab.registros);
+        base.shards.documentos_em_dia[cab.indice] = cab.registros > 0 && indice_de_documentos_atualizado(cab);
+    }
 
-        string opcao = ler_linha("[P]róxima página, [E]ditar ID, [R]emover ID, [N]ovo cadastro, [S]air: ");
-        if (!opcao.empty()) {
-            char acao = static_cast<char>(toupper(static_cast<unsigned char>(opcao[0])));
-            if (acao == 'P') {
-                indice = ate;
-                if (indice >= base.tamanho) {
-                    return;
-                }
-            } else if (acao == 'E') {
-                int id = ler_inteiro("Informe o ID para edição");
-                int pos = encontrar_indice_por_id(base, id);
-                if (pos >= 0) {
-                    manipular_cliente(base, static_cast<size_t>(pos));
-                } else {
-                    cout << endl << "ID não encontrado." << endl << endl;
-                }
-            } else if (acao == 'R') {
-                int id = ler_inteiro("Informe o ID para remoção");
-                int pos = encontrar_indice_por_id(base, id);
-                if (pos >= 0) {
-                    manipular_cliente(base, static_cast<size_t>(pos));
-                } else {
-                    cout << endl << "ID não encontrado." << endl << endl;
-                }
-            } else if (acao == 'N') {
-                inserir_cliente(base);
-            } else {
+    ok = ok && garantir_capacidade(base, registros);
+    if (ok) {
+        atomic<bool> falhou{false};
+        executar_em_paralelo(total, [&](size_t s) {
+            if (entradas[s].registros == 0) {
                 return;
             }
+            ifstream in(caminho_do_shard(entradas[s].indice), ios::binary);
+            in.seekg(static_cast<streamoff>(sizeof(CabecalhoShard)), ios::beg);
+            const streamsize bytes = static_cast<streamsize>(entradas[s].registros * sizeof(Cliente));
+            if (!in.read(reinterpret_cast<char *>(base.dados + deslocamentos[s]), bytes)) {
+                falhou = true;
+            }
+        });
+        if (falhou) {
+            cerr << "Falha ao ler os shards de dados (arquivo truncado?)." << endl;
+            ok = false;
         }
     }
-}
 
-void mostrar_trecho_interativo(BaseClientes &base) {
-    desenhar_banner("Mostrar trecho armazenado");
-    if (base.tamanho == 0) {
-        cout << "Nenhum cliente cadastrado ainda." << endl << endl;
-        return;
+    if (ok) {
+        base.tamanho = registros;
+        for (size_t s = 0; s < total; ++s) {
+            base.shards.em_disco[entradas[s].indice] = entradas[s].registros > 0;
+        }
+        base.shards.ordem_gravada = cabecalho.ordem;
+        if (cabecalho.ordem == ORDEM_POR_NOME) {
+            restaurar_ordem_por_nome(base);
+        }
+        // mudança na largura das faixas exige regravar todos os shards
+        base.shards.todos_sujos = cabecalho.ids_por_shard != base.shards.ids_por_shard;
+        if (!resumo_lido || base.resumo.total != registros) {
+            recalcular_resumo(base);
+        }
+    }
+    delete[] entradas;
+    delete[] deslocamentos;
+    return ok;
+}
+
+bool gravar_arquivo_substituindo(const string &caminho, const char *cabecalho, size_t tamanho_cabecalho,
+                                 const char *dados, size_t tamanho_dados) {
+    const string temporario = caminho + ".tmp";
+    {
+        ofstream out(temporario, ios::binary | ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(cabecalho, static_cast<streamsize>(tamanho_cabecalho));
+        if (tamanho_dados > 0) {
+            out.write(dados, static_cast<streamsize>(tamanho_dados));
+        }
+        out.flush();
+        if (!out) {
+            return false;
+        }
+    }
+    return rename(temporario.c_str(), caminho.c_str()) == 0;
+}
+
+void preencher_chave_documento(char (&chave)[sizeof(Cliente::documento)], const char *documento) {
+    memset(chave, 0, sizeof(chave));
+    memcpy(chave, documento, strnlen(documento, sizeof(chave) - 1));
+}
+
+bool documento_menor(const EntradaIndiceDocumento &a, const EntradaIndiceDocumento &b) {
+    return memcmp(a.documento, b.documento, sizeof(a.documento)) < 0;
+}
+
+// Soma FNV-1a (32 bits) dos bytes dos registros; nunca 0, que marca
+// shards gravados antes da soma existir
+uint32_t somar_registros(const Cliente *registros, size_t quantidade) {
+    uint32_t soma = 2166136261u;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(registros);
+    for (size_t i = 0; i < quantidade * sizeof(Cliente); ++i) {
+        soma = (soma ^ bytes[i]) * 16777619u;
+    }
+    return soma != 0 ? soma : 1;
+}
+
+// Regrava o índice de documentos do shard a partir dos seus registros
+bool gravar_indice_documentos(size_t indice, const Cliente *registros, size_t quantidade, uint32_t soma) {
+    EntradaIndiceDocumento *entradas = new (nothrow) EntradaIndiceDocumento[quantidade];
+    if (!entradas) {
+        return false;
+    }
+    for (size_t i = 0; i < quantidade; ++i) {
+        preencher_chave_documento(entradas[i].documento, registros[i].documento);
+        entradas[i].id = registros[i].id;
+    }
+    bool ok = ordenar_intercalando(entradas, quantidade, documento_menor);
+    if (ok) {
+        CabecalhoIndiceDocumento cab{};
+        memcpy(cab.magica, MAGICA_INDICE_DOCUMENTO, sizeof(MAGICA_INDICE_DOCUMENTO));
+        cab.versao = VERSAO_ARMAZENAMENTO;
+        cab.tamanho_entrada = sizeof(EntradaIndiceDocumento);
+        cab.indice = indice;
+        cab.registros = quantidade;
+        cab.soma_registros = soma;
+        ok = gravar_arquivo_substituindo(caminho_do_shard(indice) + SUFIXO_INDICE_DOCUMENTO,
+                                         reinterpret_cast<const char *>(&cab), sizeof(cab),
+                                         reinterpret_cast<const char *>(entradas),
+                                         quantidade * sizeof(EntradaIndiceDocumento));
+    }
+    delete[] entradas;
+    return ok;
+}
+
+// Grava a sequência de IDs da base ordenada por nome em DATA_FILE.nomes
+bool gravar_ordem_por_nome(const BaseClientes &base) {
+    int32_t *ids = new (nothrow) int32_t[base.tamanho + 1];
+    if (!ids) {
+        return false;
+    }
+    for (size_t i = 0; i < base.tamanho; ++i) {
+        ids[i] = base.dados[i].id;
+    }
+    CabecalhoOrdemNome cab{};
+    memcpy(cab.magica, MAGICA_ORDEM_NOME, sizeof(MAGICA_ORDEM_NOME));
+    cab.versao = VERSAO_ARMAZENAMENTO;
+    cab.registros = base.tamanho;
+    bool ok = gravar_arquivo_substituindo(string(DATA_FILE) + SUFIXO_ORDEM_NOME, reinterpret_cast<const char *>(&cab),
+                                          sizeof(cab), reinterpret_cast<const char *>(ids),
+                                          base.tamanho * sizeof(int32_t));
+    delete[] ids;
+    return ok;
+}
+
+// Apaga um arquivo que o manifesto já não referencia; a ausência não é erro
+bool apagar_arquivo_obsoleto(const string &caminho) {
+    if (remove(caminho.c_str()) != 0 && errno != ENOENT) {
+        cerr << "Aviso: não foi possível apagar " << caminho << ": " << strerror(errno) << endl;
+        return false;
+    }
+    return true;
+}
+
+// Grava apenas os shards com registros alterados (ou todos, quando a ordem
+// de gravação muda ou o formato ainda não é particionado) e o manifesto.
+// Cada arquivo é escrito em um temporário e renomeado, em paralelo; os
+// shards esvaziados só são apagados depois que o novo manifesto está no
+// lugar, para que uma interrupção nunca deixe o manifesto antigo
+// apontando para arquivos removidos.
+bool gravar_shards(BaseClientes &base, uint32_t ordem) {
+    EstadoShards &shards = base.shards;
+    if (ordem != shards.ordem_gravada) {
+        shards.todos_sujos = true;
+    }
+
+    size_t necessarios = 0;
+    for (size_t i = 0; i < base.tamanho; ++i) {
+        size_t indice = shard_do_id(base.dados[i].id, shards.ids_por_shard);
+        if (indice + 1 > necessarios) {
+            necessarios = indice + 1;
+        }
+    }
+    size_t limite = necessarios > shards.capacidade ? necessarios : shards.capacidade;
+    if (!garantir_capacidade_shards(shards, limite > 0 ? limite : 1)) {
+        return false;
+    }
+
+    // faixas de cada shard: contíguas quando a base está em ordem de ID;
+    // caso contrário, os registros são agrupados (de forma estável) numa cópia
+    size_t *inicio = new (nothrow) size_t[limite + 1]();
+    if (!inicio) {
+        perror("Falha ao alocar memória para os shards");
+        return false;
+    }
+    for (size_t i = 0; i < base.tamanho; ++i) {
+        inicio[shard_do_id(base.dados[i].id, shards.ids_por_shard) + 1]++;
+    }
+    for (size_t s = 0; s < limite; ++s) {
+        inicio[s + 1] += inicio[s];
+    }
+    const Cliente *agrupados = base.dados;
+    Cliente *copia = nullptr;
+    if (!ordenado_por_id(base.dados, base.tamanho)) {
+        copia = new (nothrow) Cliente[base.tamanho];
+        size_t *proximo = new (nothrow) size_t[limite + 1];
+        if (!copia || !proximo) {
+            perror("Falha ao alocar memória para os shards");
+            delete[] copia;
+            delete[] proximo;
+            delete[] inicio;
+            return false;
+        }
+        memcpy(proximo, inicio, (limite + 1) * sizeof(size_t));
+        for (size_t i = 0; i < base.tamanho; ++i) {
+            copia[proximo[shard_do_id(base.dados[i].id, shards.ids_por_shard)]++] = base.dados[i];
+        }
+        delete[] proximo;
+        agrupados = copia;
+    }
+
+    atomic<bool> falhou{false};
+    executar_em_paralelo(limite, [&](size_t s) {
+        const size_t quantidade = inicio[s + 1] - inicio[s];
+        const string caminho = caminho_do_shard(s);
+        // um shard intacto só é regravado se o seu índice de documentos
+        // faltava ou não correspondia a ele no carregamento (base de uma
+        // versão anterior)
+        if (!shards.todos_sujos && !shards.sujos[s] && (quantidade == 0 || shards.documentos_em_dia[s])) {
+            return;
+        }
+        if (quantidade == 0) {
+            return; // apagado depois da troca do manifesto
+        }
+        CabecalhoShard cab{};
+        memcpy(cab.magica, MAGICA_SHARD, sizeof(MAGICA_SHARD));
+        cab.versao = VERSAO_ARMAZENAMENTO;
+        cab.tamanho_registro = sizeof(Cliente);
+        cab.indice = s;
+        cab.id_inicial = static_cast<int32_t>(s * shards.ids_por_shard + 1);
+        cab.id_final = static_cast<int32_t>((s + 1) * shards.ids_por_shard);
+        cab.ordem = ordem;
+        cab.soma_registros = somar_registros(agrupados + inicio[s], quantidade);
+        cab.registros = quantidade;
+        if (!gravar_arquivo_substituindo(caminho, reinterpret_cast<const char *>(&cab), sizeof(cab),
+                                         reinterpret_cast<const char *>(agrupados + inicio[s]),
+                                         quantidade * sizeof(Cliente)) ||
+            !gravar_indice_documentos(s, agrupados + inicio[s], quantidade, cab.soma_registros)) {
+            falhou = true;
+        }
+    });
+
+    bool ok = !falhou && (ordem != ORDEM_POR_NOME || gravar_ordem_por_nome(base));
+    if (ok) {
+        string manifesto;
+        CabecalhoManifesto cabecalho{};
+        memcpy(cabecalho.magica, MAGICA_MANIFESTO, sizeof(MAGICA_MANIFESTO));
+        cabecalho.versao = VERSAO_ARMAZENAMENTO;
+        cabecalho.tamanho_registro = sizeof(Cliente);
+        cabecalho.ids_por_shard = shards.ids_por_shard;
+        cabecalho.ordem = ordem;
+        cabecalho.total_registros = base.tamanho;
+        for (size_t s = 0; s < limite; ++s) {
+            if (inicio[s + 1] > inicio[s]) {
+                EntradaManifesto entrada{s, inicio[s + 1] - inicio[s]};
+                manifesto.append(reinterpret_cast<const char *>(&entrada), sizeof(entrada));
+                cabecalho.total_shards++;
+            }
+        }
+        manifesto.insert(0, reinterpret_cast<const char *>(&base.resumo), sizeof(ResumoBase));
+        ok = gravar_arquivo_substituindo(DATA_FILE, reinterpret_cast<const char *>(&cabecalho), sizeof(cabecalho),
+                                         manifesto.data(), manifesto.size());
+    }
+    if (!ok) {
+        perror("Falha ao salvar dados");
+    } else {
+        for (size_t s = 0; s < limite; ++s) {
+            // um shard que não pôde ser apagado continua marcado em disco
+            // para nova tentativa na próxima gravação
+            bool apagado = true;
+            const bool vazio = inicio[s + 1] == inicio[s];
+            if (vazio && (shards.em_disco[s] || shards.sujos[s] || shards.todos_sujos)) {
+                apagado = apagar_arquivo_obsoleto(caminho_do_shard(s));
+                apagar_arquivo_obsoleto(caminho_do_shard(s) + SUFIXO_INDICE_DOCUMENTO);
+            }
+            shards.em_disco[s] = !vazio || !apagado;
+            shards.documentos_em_dia[s] = !vazio; // regravado se não estava
+            shards.sujos[s] = false;
+        }
+        if (ordem != ORDEM_POR_NOME) {
+            apagar_arquivo_obsoleto(string(DATA_FILE) + SUFIXO_ORDEM_NOME);
+        }
+        shards.todos_sujos = false;
+        shards.ordem_gravada = ordem;
+    }
+
+    delete[] copia;
+    delete[] inicio;
+    return ok;
+}
+
+bool carregar_clientes(BaseClientes &base) {
+    if (arquivo_existe(DATA_FILE)) {
+        ifstream in(DATA_FILE, ios::binary);
+        if (!in) {
+            perror("Não foi possível abrir o arquivo de dados");
+            return false;
+        }
+
+        CabecalhoManifesto cabecalho{};
+        if (ler_cabecalho_manifesto(in, cabecalho)) {
+            in.close();
+            if (!carregar_shards(base)) {
+                return false;
+            }
+            atualizar_proximo_id(base);
+            reconstruir_indices(base);
+            return true;
+        }
+
+        // formato antigo: registros contíguos, sem cabeçalho; a próxima
+        // gravação converte a base para shards
+        in.clear();
+        in.seekg(0, ios::end);
+        const streamoff bytes = in.tellg();
+        in.seekg(0, ios::beg);
+        if (bytes > 0 && !garantir_capacidade(base, static_cast<size_t>(bytes) / sizeof(Cliente))) {
+            return false;
+        }
+
+        Cliente temp{};
+        while (in.read(reinterpret_cast<char *>(&temp), sizeof(Cliente))) {
+            if (!garantir_capacidade(base, base.tamanho + 1)) {
+                return false;
+            }
+            base.dados[base.tamanho++] = temp;
+        }
+        base.shards.todos_sujos = true;
+        atualizar_proximo_id(base);
+        recalcular_resumo(base);
+        reconstruir_indices(base);
+        return true;
+    }
+
+    if (!importar_de_csv(base)) {
+        return false;
+    }
+    recalcular_resumo(base);
+    reconstruir_indices(base);
+
+    if (base.tamanho == 0) {
+        return true;
+    }
+
+    return salvar_clientes(base);
+}
+
+bool salvar_clientes(BaseClientes &base, bool ordenar_por_nome_flag) {
+    compactar_remocoes_logicas(base);
+    if (ordenar_por_nome_flag) {
+        if (!ordenar_por_nome(base)) {
+            return false;
+        }
+    } else {
+        ordenar_por_id(base.dados, base.tamanho);
+    }
+
+    if (!ha_espaco_para_salvar(base)) {
+        return false;
+    }
+
+    if (!gravar_shards(base, ordenar_por_nome_flag ? ORDEM_POR_NOME : ORDEM_POR_ID)) {
+        return false;
+    }
+    atualizar_proximo_id(base);
+    return atualizar_espelho_csv(base);
+}
+
+// --------------------------------------------------------------
+// Operações de busca (binária)
+// --------------------------------------------------------------
+
+int busca_binaria_id(const Cliente *dados, size_t quantidade, int alvo) {
+    size_t inicio = 0;
+    size_t fim = quantidade;
+    while (inicio < fim) {
+        size_t meio = inicio + (fim - inicio) / 2;
+        if (dados[meio].id == alvo) {
+            return static_cast<int>(meio);
+        }
+        if (dados[meio].id < alvo) {
+            inicio = meio + 1;
+        } else {
+            fim = meio;
+        }
+    }
+    return -1;
+}
+
+// Busca binária pelo nível primário da colação: "Mario Rafael Souza"
+// encontra "Mário Rafael Souza". A ordem por nome fica em cache até a
+// próxima alteração da base. Retorna a posição em base.dados.
+int busca_binaria_nome(BaseClientes &base, const string &nome) {
+    ChaveColacao procurada;
+    gerar_chave_colacao(nome.c_str(), procurada);
+    const string primario = procurada.completa.substr(0, procurada.completa.find('\x01'));
+    if (!atualizar_ordem_por_nome(base)) {
+        return -1;
+    }
+
+    const CacheColacao &cache = base.colacao_nome;
+    int encontrado = 0;
+    size_t inicio = 0;
+    size_t fim = cache.total_ordem;
+    while (inicio < fim) {
+        size_t meio = inicio + (fim - inicio) / 2;
+        const ChaveColacao *chave = procurar_chave_colacao(cache, cache.ordem_por_nome[meio]);
+        if (!chave) {
+            return -1; // não acontece: a ordem é descartada junto com as chaves
+        }
+        int comparacao = 0;
+        if (chave->prefixo != procurada.prefixo) {
+            comparacao = chave->prefixo < procurada.prefixo ? -1 : 1;
+        } else {
+            comparacao = chave->completa.compare(0, chave->completa.find('\x01'), primario);
+        }
+        if (comparacao == 0) {
+            encontrado = cache.ordem_por_nome[meio];
+            break;
+        }
+        if (comparacao < 0) {
+            inicio = meio + 1;
+        } else {
+            fim = meio;
+        }
+    }
+    return encontrado > 0 ? encontrar_indice_por_id(base, encontrado) : -1;
+}
+
+// --------------------------------------------------------------
+// Indicadores resumidos (contadores materializados)
+// --------------------------------------------------------------
+
+size_t posicao_situacao(char situacao) {
+    return situacao == 'A' ? 0 : situacao == 'I' ? 1 : 2;
+}
+
+size_t posicao_tipo(char tipo) {
+    return tipo == 'F' ? 0 : tipo == 'J' ? 1 : 2;
+}
+
+size_t posicao_estado_civil(char estado) {
+    switch (estado) {
+        case 'S': return 0;
+        case 'C': return 1;
+        case 'V': return 2;
+        case 'D': return 3;
+        default: return 4;
+    }
+}
+
+int64_t limite_em_centavos(float limite) {
+    return static_cast<int64_t>(llround(static_cast<double>(limite) * 100.0));
+}
+
+// Soma (entrada) ou subtrai (saída) o cliente dos contadores em O(1).
+// Registros removidos logicamente (ID negativo) já saíram da contagem.
+void contabilizar_cliente(ResumoBase &resumo, const Cliente &c, bool entrada) {
+    if (c.id <= 0) {
+        return;
+    }
+    const uint64_t delta = entrada ? 1 : static_cast<uint64_t>(-1); // aritmética modular
+    resumo.total += delta;
+    resumo.por_situacao[posicao_situacao(c.situacao_cadastral)] += delta;
+    resumo.por_tipo[posicao_tipo(c.tipo_cliente)] += delta;
+    resumo.por_estado_civil[posicao_estado_civil(c.estado_civil)] += delta;
+    const int64_t centavos = limite_em_centavos(c.limite_credito);
+    resumo.soma_limites_centavos += entrada ? centavos : -centavos;
+}
+
+// Contagem completa: usada só quando o arquivo não traz os contadores
+// (CSV, formato antigo ou manifesto da versão 1)
+void recalcular_resumo(BaseClientes &base) {
+    base.resumo = ResumoBase{};
+    for (size_t i = 0; i < base.tamanho; ++i) {
+        contabilizar_cliente(base.resumo, base.dados[i], true);
+    }
+}
+
+double percentual(uint64_t parte, uint64_t total) {
+    return total == 0 ? 0.0 : 100.0 * static_cast<double>(parte) / static_cast<double>(total);
+}
+
+void escrever_contador(ostream &saida, const char *rotulo, uint64_t valor, uint64_t total) {
+    // alinha pelo número de caracteres, não de bytes UTF-8
+    size_t largura = 0;
+    for (const char *p = rotulo; *p; ++p) {
+        largura += (static_cast<unsigned char>(*p) & 0xC0) != 0x80;
+    }
+    saida << "  " << rotulo << string(largura < 18 ? 18 - largura : 1, ' ') << setw(10) << valor << setw(9) << fixed
+          << setprecision(1) << percentual(valor, total) << "%\n";
+}
+
+// Painel montado apenas com os contadores, sem percorrer os registros
+void exibir_painel(const BaseClientes &base) {
+    const ResumoBase &r = base.resumo;
+    ostringstream tela;
+    desenhar_banner(tela, "Painel de indicadores");
+    tela << "Clientes cadastrados: " << r.total << "\n\n";
+
+    tela << "Situação cadastral\n";
+    escrever_contador(tela, "Ativos", r.por_situacao[0], r.total);
+    escrever_contador(tela, "Inativos", r.por_situacao[1], r.total);
+    if (r.por_situacao[2] > 0) {
+        escrever_contador(tela, "Outros", r.por_situacao[2], r.total);
+    }
+
+    tela << "\nTipo de cliente\n";
+    escrever_contador(tela, "Pessoa física", r.por_tipo[0], r.total);
+    escrever_contador(tela, "Pessoa jurídica", r.por_tipo[1], r.total);
+    if (r.por_tipo[2] > 0) {
+        escrever_contador(tela, "Outros", r.por_tipo[2], r.total);
+    }
+
+    tela << "\nEstado civil\n";
+    const char *const estados[] = {"Solteiro(a)", "Casado(a)", "Viúvo(a)", "Divorciado(a)", "Outros"};
+    for (size_t i = 0; i < 5; ++i) {
+        if (i < 4 || r.por_estado_civil[i] > 0) {
+            escrever_contador(tela, estados[i], r.por_estado_civil[i], r.total);
+        }
+    }
+
+    const double soma = static_cast<double>(r.soma_limites_centavos) / 100.0;
+    tela << "\nLimite de crédito\n";
+    tela << "  Total: R$ " << fixed << setprecision(2) << soma << "\n";
+    tela << "  Média: R$ " << (r.total == 0 ? 0.0 : soma / static_cast<double>(r.total)) << "\n\n";
+    escrever_tela(tela.str());
+}
+
+// --------------------------------------------------------------
+// Ranking de limite de crédito (árvore de estatísticas de ordem)
+// --------------------------------------------------------------
+
+constexpr size_t MAX_RESULTADOS_RANKING = 1000;
+
+const char *const NOMES_SEGMENTOS[TOTAL_SEGMENTOS] = {
+    "todos", "ativos", "pessoa física", "pessoa jurídica", "ativos - pessoa física", "ativos - pessoa jurídica",
+};
+
+bool pertence_ao_segmento(const Cliente &c, size_t segmento) {
+    // um limite NaN não tem posição na ordem da árvore (toda comparação é
+    // falsa) e nunca seria removido; fica fora de todos os segmentos
+    if (!isfinite(c.limite_credito)) {
+        return false;
+    }
+    const bool ativo = c.situacao_cadastral == 'A';
+    switch (segmento) {
+        case SEGMENTO_TODOS: return true;
+        case SEGMENTO_ATIVOS: return ativo;
+        case SEGMENTO_FISICA: return c.tipo_cliente == 'F';
+        case SEGMENTO_JURIDICA: return c.tipo_cliente == 'J';
+        case SEGMENTO_ATIVOS_FISICA: return ativo && c.tipo_cliente == 'F';
+        default: return ativo && c.tipo_cliente == 'J';
+    }
+}
+
+// Ordem da árvore: limite crescente, desempate pelo ID
+bool chave_menor(float limite_a, int id_a, float limite_b, int id_b) {
+    return limite_a < limite_b || (limite_a == limite_b && id_a < id_b);
+}
+
+uint32_t sortear_prioridade() {
+    static uint32_t estado = 2463534242u; // xorshift32
+    estado ^= estado << 13;
+    estado ^= estado >> 17;
+    estado ^= estado << 5;
+    return estado;
+}
+
+uint32_t tamanho_no(const ArvoreRanking &arvore, int no) {
+    return no < 0 ? 0 : arvore.nos[no].tamanho;
+}
+
+void atualizar_tamanho(ArvoreRanking &arvore, int no) {
+    NoRanking &n = arvore.nos[no];
+    n.tamanho = 1 + tamanho_no(arvore, n.esquerda) + tamanho_no(arvore, n.direita);
+}
+
+int alocar_no(ArvoreRanking &arvore, float limite, int id) {
+    int no = arvore.livre;
+    if (no >= 0) {
+        arvore.livre = arvore.nos[no].direita;
+    } else {
+        if (arvore.usados == arvore.capacidade) {
+            size_t capacidade_alvo = arvore.capacidade == 0 ? 64 : arvore.capacidade * 2;
+            NoRanking *novos = new (nothrow) NoRanking[capacidade_alvo];
+            if (!novos) {
+                perror("Falha ao alocar memória para o ranking");
+                return -1;
+            }
+            for (size_t i = 0; i < arvore.usados; ++i) {
+                novos[i] = arvore.nos[i];
+            }
+            delete[] arvore.nos;
+            arvore.nos = novos;
+            arvore.capacidade = capacidade_alvo;
+        }
+        no = static_cast<int>(arvore.usados++);
+    }
+    NoRanking &n = arvore.nos[no];
+    n.limite = limite;
+    n.id = id;
+    n.prioridade = sortear_prioridade();
+    n.esquerda = -1;
+    n.direita = -1;
+    n.tamanho = 1;
+    return no;
+}
+
+void liberar_arvore(ArvoreRanking &arvore) {
+    delete[] arvore.nos;
+    arvore = ArvoreRanking{};
+}
+
+// Divide a subárvore em chaves < (limite, id) e chaves >= (limite, id)
+void dividir(ArvoreRanking &arvore, int no, float limite, int id, int &menores, int &demais) {
+    if (no < 0) {
+        menores = -1;
+        demais = -1;
+        return;
+    }
+    NoRanking &n = arvore.nos[no];
+    if (chave_menor(n.limite, n.id, limite, id)) {
+        dividir(arvore, n.direita, limite, id, n.direita, demais);
+        menores = no;
+    } else {
+        dividir(arvore, n.esquerda, limite, id, menores, n.esquerda);
+        demais = no;
+    }
+    atualizar_tamanho(arvore, no);
+}
+
+// Une duas subárvores em que todas as chaves de 'a' precedem as de 'b'
+int unir(ArvoreRanking &arvore, int a, int b) {
+    if (a < 0) {
+        return b;
+    }
+    if (b < 0) {
+        return a;
+    }
+    if (arvore.nos[a].prioridade > arvore.nos[b].prioridade) {
+        arvore.nos[a].direita = unir(arvore, arvore.nos[a].direita, b);
+        atualizar_tamanho(arvore, a);
+        return a;
+    }
+    arvore.nos[b].esquerda = unir(arvore, a, arvore.nos[b].esquerda);
+    atualizar_tamanho(arvore, b);
+    return b;
+}
+
+void inserir_na_arvore(ArvoreRanking &arvore, float limite, int id) {
+    int novo = alocar_no(arvore, limite, id);
+    if (novo < 0) {
+        return;
+    }
+    int menores = -1;
+    int demais = -1;
+    dividir(arvore, arvore.raiz, limite, id, menores, demais);
+    arvore.raiz = unir(arvore, unir(arvore, menores, novo), demais);
+}
+
+void remover_da_arvore(ArvoreRanking &arvore, float limite, int id) {
+    int menores = -1;
+    int demais = -1;
+    dividir(arvore, arvore.raiz, limite, id, menores, demais);
+    // o menor nó de 'demais' é o procurado, se existir
+    int pai = -1;
+    int no = demais;
+    while (no >= 0 && arvore.nos[no].esquerda >= 0) {
+        pai = no;
+        no = arvore.nos[no].esquerda;
+    }
+    if (no >= 0 && arvore.nos[no].limite == limite && arvore.nos[no].id == id) {
+        int substituto = arvore.nos[no].direita;
+        if (pai < 0) {
+            demais = substituto;
+        } else {
+            arvore.nos[pai].esquerda = substituto;
+            // recalcula os tamanhos no caminho da raiz de 'demais' até o pai
+            for (int atual = demais; atual >= 0 && atual != substituto; atual = arvore.nos[atual].esquerda) {
+                arvore.nos[atual].tamanho--;
+            }
+        }
+        arvore.nos[no].direita = arvore.livre;
+        arvore.livre = no;
+    }
+    arvore.raiz = unir(arvore, menores, demais);
+}
+
+// Quantidade de chaves menores que (limite, id)
+size_t contar_menores(const ArvoreRanking &arvore, float limite, int id) {
+    size_t contagem = 0;
+    int no = arvore.raiz;
+    while (no >= 0) {
+        const NoRanking &n = arvore.nos[no];
+        if (chave_menor(n.limite, n.id, limite, id)) {
+            contagem += tamanho_no(arvore, n.esquerda) + 1;
+            no = n.direita;
+        } else {
+            no = n.esquerda;
+        }
+    }
+    return contagem;
+}
+
+uint32_t calcular_tamanhos(ArvoreRanking &arvore, int no) {
+    if (no < 0) {
+        return 0;
+    }
+    NoRanking &n = arvore.nos[no];
+    n.tamanho = 1 + calcular_tamanhos(arvore, n.esquerda) + calcular_tamanhos(arvore, n.direita);
+    return n.tamanho;
+}
+
+// Constrói a árvore em O(n) a partir de chaves já ordenadas (árvore
+// cartesiana: a pilha guarda o ramo direito ainda aberto)
+bool construir_arvore(ArvoreRanking &arvore, const ChaveRanking *chaves, size_t quantidade) {
+    liberar_arvore(arvore);
+    if (quantidade == 0) {
+        return true;
+    }
+    arvore.nos = new (nothrow) NoRanking[quantidade];
+    int *pilha = new (nothrow) int[quantidade];
+    if (!arvore.nos || !pilha) {
+        perror("Falha ao alocar memória para o ranking");
+        delete[] pilha;
+        liberar_arvore(arvore);
+        return false;
+    }
+    arvore.capacidade = quantidade;
+
+    size_t topo = 0;
+    for (size_t i = 0; i < quantidade; ++i) {
+        int novo = alocar_no(arvore, chaves[i].limite, chaves[i].id);
+        int ultimo = -1;
+        while (topo > 0 && arvore.nos[pilha[topo - 1]].prioridade < arvore.nos[novo].prioridade) {
+            ultimo = pilha[--topo];
+        }
+        arvore.nos[novo].esquerda = ultimo;
+        if (topo > 0) {
+            arvore.nos[pilha[topo - 1]].direita = novo;
+        }
+        pilha[topo++] = novo;
+    }
+    arvore.raiz = pilha[0];
+    delete[] pilha;
+    calcular_tamanhos(arvore, arvore.raiz);
+    return true;
+}
+
+void ranking_inserir(BaseClientes &base, const Cliente &c) {
+    if (c.id <= 0) {
+        return;
+    }
+    for (size_t s = 0; s < TOTAL_SEGMENTOS; ++s) {
+        if (pertence_ao_segmento(c, s)) {
+            inserir_na_arvore(base.ranking[s], c.limite_credito, c.id);
+        }
+    }
+}
+
+void ranking_remover(BaseClientes &base, const Cliente &c) {
+    if (c.id <= 0) {
+        return;
+    }
+    for (size_t s = 0; s < TOTAL_SEGMENTOS; ++s) {
+        if (pertence_ao_segmento(c, s)) {
+            remover_da_arvore(base.ranking[s], c.limite_credito, c.id);
+        }
+    }
+}
+
+void reconstruir_rankings(BaseClientes &base) {
+    size_t *ordem = new (nothrow) size_t[base.tamanho + 1];
+    ChaveRanking *filtradas = new (nothrow) ChaveRanking[base.tamanho + 1];
+    bool ok = ordem && filtradas;
+    size_t ativos = 0;
+    if (ok) {
+        for (size_t i = 0; i < base.tamanho; ++i) {
+            if (base.dados[i].id > 0) {
+                ordem[ativos++] = i;
+            }
+        }
+        const Cliente *dados = base.dados;
+        ok = ordenar_intercalando(ordem, ativos, [dados](size_t a, size_t b) {
+            return chave_menor(dados[a].limite_credito, dados[a].id, dados[b].limite_credito, dados[b].id);
+        });
+    }
+    for (size_t s = 0; ok && s < TOTAL_SEGMENTOS; ++s) {
+        size_t quantidade = 0;
+        for (size_t i = 0; i < ativos; ++i) {
+            const Cliente &c = base.dados[ordem[i]];
+            if (pertence_ao_segmento(c, s)) {
+                filtradas[quantidade].limite = c.limite_credito;
+                filtradas[quantidade++].id = c.id;
+            }
+        }
+        ok = construir_arvore(base.ranking[s], filtradas, quantidade);
+    }
+    if (!ok) {
+        // sem memória para a construção em lote: inserções individuais
+        for (size_t s = 0; s < TOTAL_SEGMENTOS; ++s) {
+            liberar_arvore(base.ranking[s]);
+        }
+        for (size_t i = 0; i < base.tamanho; ++i) {
+            ranking_inserir(base, base.dados[i]);
+        }
+    }
+    delete[] ordem;
+    delete[] filtradas;
+}
+
+bool empilhar(int *&pilha, size_t &topo, size_t &capacidade, int no) {
+    if (topo == capacidade) {
+        size_t capacidade_alvo = capacidade == 0 ? 64 : capacidade * 2;
+        int *nova = new (nothrow) int[capacidade_alvo];
+        if (!nova) {
+            perror("Falha ao alocar memória para o ranking");
+            return false;
+        }
+        for (size_t i = 0; i < topo; ++i) {
+            nova[i] = pilha[i];
+        }
+        delete[] pilha;
+        pilha = nova;
+        capacidade = capacidade_alvo;
+    }
+    pilha[topo++] = no;
+    return true;
+}
+
+// Percorre em ordem a partir da posição 'inicio' (0 = menor chave no
+// sentido crescente, maior no decrescente), parando no primeiro limite
+// fora de [minimo, maximo_limite] ou após 'maximo' chaves. Custo O(log n + k).
+size_t percorrer_ranking(const ArvoreRanking &arvore, size_t inicio, bool decrescente, float minimo,
+                         float maximo_limite, ChaveRanking *saida, size_t maximo) {
+    if (inicio >= tamanho_no(arvore, arvore.raiz) || maximo == 0) {
+        return 0;
+    }
+    int *pilha = nullptr;
+    size_t topo = 0;
+    size_t capacidade = 0;
+    bool ok = true;
+
+    // desce até o nó da posição pedida, empilhando os ancestrais que ainda
+    // serão visitados no sentido do percurso
+    size_t alvo = inicio;
+    int no = arvore.raiz;
+    while (ok && no >= 0) {
+        const NoRanking &n = arvore.nos[no];
+        const int antes_do_no = decrescente ? n.direita : n.esquerda;
+        const int depois_do_no = decrescente ? n.esquerda : n.direita;
+        size_t antes = tamanho_no(arvore, antes_do_no);
+        if (alvo < antes) {
+            ok = empilhar(pilha, topo, capacidade, no);
+            no = antes_do_no;
+        } else if (alvo == antes) {
+            ok = empilhar(pilha, topo, capacidade, no);
+            no = -1;
+        } else {
+            alvo -= antes + 1;
+            no = depois_do_no;
+        }
+    }
+
+    size_t quantidade = 0;
+    while (ok && topo > 0 && quantidade < maximo) {
+        const NoRanking &n = arvore.nos[pilha[--topo]];
+        if (n.limite < minimo || n.limite > maximo_limite) {
+            break;
+        }
+        saida[quantidade].limite = n.limite;
+        saida[quantidade++].id = n.id;
+        int filho = decrescente ? n.esquerda : n.direita;
+        while (ok && filho >= 0) {
+            ok = empilhar(pilha, topo, capacidade, filho);
+            filho = decrescente ? arvore.nos[filho].direita : arvore.nos[filho].esquerda;
+        }
+    }
+    delete[] pilha;
+    return quantidade;
+}
+
+size_t escolher_segmento() {
+    char somente_ativos = ler_char("Somente clientes ativos? (S/N)");
+    char tipo = ler_char("Tipo de cliente (F/J, ENTER para todos)");
+    size_t segmento = SEGMENTO_TODOS;
+    if (tipo == 'F') {
+        segmento = somente_ativos == 'S' ? SEGMENTO_ATIVOS_FISICA : SEGMENTO_FISICA;
+    } else if (tipo == 'J') {
+        segmento = somente_ativos == 'S' ? SEGMENTO_ATIVOS_JURIDICA : SEGMENTO_JURIDICA;
+    } else if (somente_ativos == 'S') {
+        segmento = SEGMENTO_ATIVOS;
+    }
+    return segmento;
+}
+
+void exibir_ranking(BaseClientes &base, const ChaveRanking *resultados, size_t quantidade, size_t primeira_posicao,
+                    bool decrescente, size_t total) {
+    ordenar_por_id(base.dados, base.tamanho);
+    ostringstream tela;
+    tela << "\n" << setw(10) << left << "Posição" << setw(8) << "ID" << setw(36) << "Nome" << "Limite (R$)\n";
+    tela << "--------------------------------------------------------------------\n";
+    for (size_t i = 0; i < quantidade; ++i) {
+        int pos = busca_binaria_id(base.dados, base.tamanho, resultados[i].id);
+        size_t posicao = decrescente ? primeira_posicao + i + 1 : total - (primeira_posicao + i);
+        tela << setw(8) << left << posicao << setw(8) << resultados[i].id << setw(36)
+             << (pos >= 0 ? base.dados[pos].nome_completo : "?") << fixed << setprecision(2)
+             << resultados[i].limite << "\n";
+    }
+    tela << "\n" << quantidade << " cliente(s) listado(s) de " << total << " no segmento.\n\n";
+    escrever_tela(tela.str());
+}
+
+void submenu_ranking(BaseClientes &base) {
+    bool sair = false;
+    ChaveRanking *resultados = new (nothrow) ChaveRanking[MAX_RESULTADOS_RANKING];
+    if (!resultados) {
+        perror("Falha ao alocar memória");
+        return;
+    }
+    while (!sair) {
+        ostringstream tela;
+        desenhar_banner(tela, "Ranking de limite de crédito");
+        tela << "1 - Maiores limites (top K)\n";
+        tela << "2 - Menores limites (K últimos)\n";
+        tela << "3 - Posição de um cliente no ranking\n";
+        tela << "4 - Clientes por faixa de limite\n";
+        tela << "0 - Voltar\n";
+        escrever_tela(tela.str());
+
+        int opcao = ler_inteiro("Escolha uma opção");
+        if (opcao == 0) {
+            sair = true;
+            continue;
+        }
+        if (opcao < 1 || opcao > 4) {
+            cout << "Opção inválida." << endl;
+            pausar();
+            continue;
+        }
+
+        const size_t segmento = escolher_segmento();
+        const ArvoreRanking &arvore = base.ranking[segmento];
+        const size_t total = tamanho_no(arvore, arvore.raiz);
+        const float sem_limite = numeric_limits<float>::max();
+        cout << "Segmento: " << NOMES_SEGMENTOS[segmento] << " (" << total << " clientes)" << endl;
+
+        if (opcao == 1 || opcao == 2) {
+            int k = ler_inteiro("Quantidade de clientes (K)");
+            size_t maximo = k < 1 ? 0 : static_cast<size_t>(k);
+            if (maximo > MAX_RESULTADOS_RANKING) {
+                maximo = MAX_RESULTADOS_RANKING;
+            }
+            const bool decrescente = opcao == 1;
+            size_t quantidade = percorrer_ranking(arvore, 0, decrescente, -sem_limite, sem_limite, resultados, maximo);
+            exibir_ranking(base, resultados, quantidade, 0, decrescente, total);
+        } else if (opcao == 3) {
+            int id = ler_inteiro("Informe o ID do cliente");
+            int indice = encontrar_indice_por_id(base, id);
+            if (indice < 0 || !pertence_ao_segmento(base.dados[indice], segmento)) {
+                cout << endl << "Cliente não encontrado neste segmento." << endl << endl;
+            } else {
+                const Cliente &c = base.dados[indice];
+                size_t menores = contar_menores(arvore, c.limite_credito, c.id);
+                cout << endl
+                     << c.nome_completo << " ocupa a posição " << total - menores << " de " << total
+                     << " (maiores limites primeiro), com limite de R$ " << fixed << setprecision(2)
+                     << c.limite_credito << "." << endl
+                     << endl;
+            }
+        } else {
+            float minimo = ler_float("Limite mínimo");
+            float maximo = ler_float("Limite máximo");
+            // primeira chave >= (minimo, menor ID possível)
+            size_t inicio = contar_menores(arvore, minimo, numeric_limits<int>::min());
+            size_t ate_o_maximo = contar_menores(arvore, maximo, numeric_limits<int>::max());
+            size_t na_faixa = ate_o_maximo > inicio ? ate_o_maximo - inicio : 0;
+            size_t quantidade =
+                percorrer_ranking(arvore, inicio, false, minimo, maximo, resultados, MAX_RESULTADOS_RANKING);
+            cout << endl << na_faixa << " cliente(s) com limite entre R$ " << fixed << setprecision(2) << minimo
+                 << " e R$ " << maximo << "." << endl;
+            exibir_ranking(base, resultados, quantidade, inicio, false, total);
+        }
+        pausar();
+    }
+    delete[] resultados;
+}
+
+// --------------------------------------------------------------
+// Índice de trigramas (busca aproximada por nome e endereço)
+// --------------------------------------------------------------
+
+// Alfabeto dobrado: espaço, 'a'-'z' e '0'-'9' (37 símbolos)
+constexpr uint32_t SIMBOLOS_TRIGRAMA = 37;
+constexpr uint32_t TOTAL_TRIGRAMAS = SIMBOLOS_TRIGRAMA * SIMBOLOS_TRIGRAMA * SIMBOLOS_TRIGRAMA;
+constexpr size_t MAX_TRIGRAMAS = 3 * MAX_TEXT;
+constexpr size_t MAX_RESULTADOS_APROXIMADOS = 20;
+constexpr double SIMILARIDADE_MINIMA = 0.3;
+
+struct ConjuntoTrigramas {
+    uint32_t itens[MAX_TRIGRAMAS];
+    size_t tamanho = 0;
+};
+
+// Converte o ponto de código Latin-1 (0xC0-0xFF) na letra base sem acento
+char letra_sem_acento(unsigned int codigo) {
+    if (codigo == 0xFF) {
+        return 'y';
+    }
+    if (codigo >= 0xE0) {
+        codigo -= 0x20; // minúsculas acentuadas -> maiúsculas
+    }
+    if (codigo <= 0xC5) return 'a';
+    if (codigo == 0xC7) return 'c';
+    if (codigo >= 0xC8 && codigo <= 0xCB) return 'e';
+    if (codigo >= 0xCC && codigo <= 0xCF) return 'i';
+    if (codigo == 0xD1) return 'n';
+    if (codigo >= 0xD2 && codigo <= 0xD6) return 'o';
+    if (codigo >= 0xD9 && codigo <= 0xDC) return 'u';
+    if (codigo == 0xDD) return 'y';
+    return ' ';
+}
+
+// Normaliza o texto UTF-8 para minúsculas sem acentos, com palavras
+// separadas por um único espaço (sem espaços nas pontas)
+string dobrar_texto(const char *texto) {
+    string saida;
+    for (size_t i = 0; texto[i] != '\0' && saida.size() < MAX_TEXT - 1; ++i) {
+        unsigned char c = static_cast<unsigned char>(texto[i]);
+        char convertido = ' ';
+        if (isalnum(c) && c < 0x80) {
+            convertido = static_cast<char>(tolower(c));
+        } else if (c == 0xC3 && texto[i + 1] != '\0') {
+            unsigned char seguinte = static_cast<unsigned char>(texto[++i]);
+            convertido = letra_sem_acento(0xC0u + (seguinte & 0x3Fu));
+        } else if (c >= 0xC0) {
+            // demais sequências multibyte: ignora os bytes de continuação
+            while ((static_cast<unsigned char>(texto[i + 1]) & 0xC0u) == 0x80u) {
+                ++i;
+            }
+        }
+
+        if (convertido == ' ') {
+            if (!saida.empty() && saida.back() != ' ') {
+                saida += ' ';
+            }
+        } else {
+            saida += convertido;
+        }
+    }
+    if (!saida.empty() && saida.back() == ' ') {
+        saida.pop_back();
+    }
+    return saida;
+}
+
+uint32_t codigo_simbolo(char c) {
+    if (c >= 'a' && c <= 'z') {
+        return static_cast<uint32_t>(c - 'a') + 1;
+    }
+    if (c >= '0' && c <= '9') {
+        return static_cast<uint32_t>(c - '0') + 27;
+    }
+    return 0;
+}
+
+uint32_t codigo_trigrama(char a, char b, char c) {
+    return (codigo_simbolo(a) * SIMBOLOS_TRIGRAMA + codigo_simbolo(b)) * SIMBOLOS_TRIGRAMA +
+           codigo_simbolo(c);
+}
+
+void adicionar_trigrama(ConjuntoTrigramas &conjunto, uint32_t trigrama) {
+    // inserção ordenada sem repetição (conjuntos pequenos)
+    size_t pos = conjunto.tamanho;
+    while (pos > 0 && conjunto.itens[pos - 1] > trigrama) {
+        --pos;
+    }
+    if (pos > 0 && conjunto.itens[pos - 1] == trigrama) {
+        return;
+    }
+    if (conjunto.tamanho == MAX_TRIGRAMAS) {
+        return;
+    }
+    for (size_t i = conjunto.tamanho; i > pos; --i) {
+        conjunto.itens[i] = conjunto.itens[i - 1];
+    }
+    conjunto.itens[pos] = trigrama;
+    conjunto.tamanho++;
+}
+
+// Extrai os trigramas de um texto já dobrado. Com 'completos', cada palavra
+// recebe dois espaços à esquerda e um à direita (como no índice). Sem eles,
+// só entram trigramas garantidamente presentes em qualquer texto que
+// contenha o trecho: bordas apenas entre palavras do próprio trecho.
+ConjuntoTrigramas extrair_trigramas(const string &dobrado, bool completos) {
+    ConjuntoTrigramas conjunto;
+    size_t inicio = 0;
+    while (inicio < dobrado.size()) {
+        size_t fim = dobrado.find(' ', inicio);
+        if (fim == string::npos) {
+            fim = dobrado.size();
+        }
+        bool borda_esquerda = completos || inicio > 0;
+        bool borda_direita = completos || fim < dobrado.size();
+
+        string palavra;
+        if (borda_esquerda) {
+            palavra += "  ";
+        }
+        palavra += dobrado.substr(inicio, fim - inicio);
+        if (borda_direita) {
+            palavra += ' ';
+        }
+        for (size_t i = 0; i + 2 < palavra.size(); ++i) {
+            adicionar_trigrama(conjunto, codigo_trigrama(palavra[i], palavra[i + 1], palavra[i + 2]));
+        }
+        inicio = fim + 1;
+    }
+    return conjunto;
+}
+
+bool garantir_capacidade_lista(ListaIds &lista, uint32_t nova_capacidade) {
+    if (nova_capacidade <= lista.capacidade) {
+        return true;
+    }
+    uint32_t capacidade_alvo = lista.capacidade == 0 ? 4 : lista.capacidade;
+    while (capacidade_alvo < nova_capacidade) {
+        capacidade_alvo *= 2;
+    }
+    int *novo_buffer = new (nothrow) int[capacidade_alvo];
+    if (!novo_buffer) {
+        perror("Falha ao alocar memória para o índice");
+        return false;
+    }
+    for (uint32_t i = 0; i < lista.tamanho; ++i) {
+        novo_buffer[i] = lista.ids[i];
+    }
+    delete[] lista.ids;
+    lista.ids = novo_buffer;
+    lista.capacidade = capacidade_alvo;
+    return true;
+}
+
+// Primeira posição da lista cujo ID é >= alvo
+uint32_t limite_inferior_lista(const ListaIds &lista, int alvo) {
+    uint32_t inicio = 0;
+    uint32_t fim = lista.tamanho;
+    while (inicio < fim) {
+        uint32_t meio = inicio + (fim - inicio) / 2;
+        if (lista.ids[meio] < alvo) {
+            inicio = meio + 1;
+        } else {
+            fim = meio;
+        }
+    }
+    return inicio;
+}
+
+void inserir_na_lista(ListaIds &lista, int id) {
+    if (lista.tamanho > 0 && lista.ids[lista.tamanho - 1] >= id) {
+        uint32_t pos = limite_inferior_lista(lista, id);
+        if (lista.ids[pos] == id || !garantir_capacidade_lista(lista, lista.tamanho + 1)) {
+            return;
+        }
+        for (uint32_t i = lista.tamanho; i > pos; --i) {
+            lista.ids[i] = lista.ids[i - 1];
+        }
+        lista.ids[pos] = id;
+        lista.tamanho++;
+        return;
+    }
+    // caso comum: IDs novos são sempre os maiores
+    if (garantir_capacidade_lista(lista, lista.tamanho + 1)) {
+        lista.ids[lista.tamanho++] = id;
+    }
+}
+
+void remover_da_lista(ListaIds &lista, int id) {
+    uint32_t pos = limite_inferior_lista(lista, id);
+    if (pos >= lista.tamanho || lista.ids[pos] != id) {
+        return;
+    }
+    for (uint32_t i = pos; i + 1 < lista.tamanho; ++i) {
+        lista.ids[i] = lista.ids[i + 1];
+    }
+    lista.tamanho--;
+}
+
+void liberar_indice(IndiceTrigramas &indice) {
+    if (!indice.listas) {
+        return;
+    }
+    for (uint32_t t = 0; t < TOTAL_TRIGRAMAS; ++t) {
+        delete[] indice.listas[t].ids;
+    }
+    delete[] indice.listas;
+    indice.listas = nullptr;
+}
+
+bool preparar_indice(IndiceTrigramas &indice) {
+    if (indice.listas) {
+        return true;
+    }
+    indice.listas = new (nothrow) ListaIds[TOTAL_TRIGRAMAS];
+    if (!indice.listas) {
+        perror("Falha ao alocar memória para o índice");
+        return false;
+    }
+    return true;
+}
+
+void indexar_texto(IndiceTrigramas &indice, int id, const char *texto) {
+    if (id <= 0 || !preparar_indice(indice)) {
+        return;
+    }
+    ConjuntoTrigramas conjunto = extrair_trigramas(dobrar_texto(texto), true);
+    for (size_t i = 0; i < conjunto.tamanho; ++i) {
+        inserir_na_lista(indice.listas[conjunto.itens[i]], id);
+    }
+}
+
+void desindexar_texto(IndiceTrigramas &indice, int id, const char *texto) {
+    if (id <= 0 || !indice.listas) {
+        return;
+    }
+    ConjuntoTrigramas conjunto = extrair_trigramas(dobrar_texto(texto), true);
+    for (size_t i = 0; i < conjunto.tamanho; ++i) {
+        remover_da_lista(indice.listas[conjunto.itens[i]], id);
+    }
+}
+
+void reconstruir_indices(BaseClientes &base) {
+    liberar_indice(base.indice_nome);
+    liberar_indice(base.indice_endereco);
+    liberar_cache_colacao(base.colacao_nome);
+    if (base.indices_suspensos) {
+        return;
+    }
+    reconstruir_rankings(base);
+
+    // as listas de postagens crescem só por anexação quando os registros
+    // são visitados em ordem de ID, mesmo que a base esteja ordenada por nome
+    size_t *ordem = nullptr;
+    if (!ordenado_por_id(base.dados, base.tamanho)) {
+        ordem = new (nothrow) size_t[base.tamanho];
+        if (ordem) {
+            for (size_t i = 0; i < base.tamanho; ++i) {
+                ordem[i] = i;
+            }
+            const Cliente *dados = base.dados;
+            ordenar_intercalando(ordem, base.tamanho,
+                                 [dados](size_t a, size_t b) { return dados[a].id < dados[b].id; });
+        }
+    }
+    for (size_t i = 0; i < base.tamanho; ++i) {
+        const Cliente &c = base.dados[ordem ? ordem[i] : i];
+        indexar_texto(base.indice_nome, c.id, c.nome_completo);
+        indexar_texto(base.indice_endereco, c.id, c.endereco);
+    }
+    delete[] ordem;
+}
+
+// Ganchos chamados por toda operação que altera a base em memória
+void registrar_insercao(BaseClientes &base, const Cliente &c) {
+    descartar_chave_nome(base, c.id); // regerada sob demanda na próxima ordenação ou busca
+    marcar_shard_sujo(base, c.id);
+    registrar_pendencia_csv(base, c.id);
+    contabilizar_cliente(base.resumo, c, true);
+    if (!base.indices_suspensos) {
+        indexar_texto(base.indice_nome, c.id, c.nome_completo);
+        indexar_texto(base.indice_endereco, c.id, c.endereco);
+        ranking_inserir(base, c);
+    }
+}
+
+void registrar_remocao(BaseClientes &base, const Cliente &c) {
+    descartar_chave_nome(base, c.id);
+    marcar_shard_sujo(base, c.id);
+    registrar_pendencia_csv(base, c.id);
+    contabilizar_cliente(base.resumo, c, false);
+    if (!base.indices_suspensos) {
+        desindexar_texto(base.indice_nome, c.id, c.nome_completo);
+        desindexar_texto(base.indice_endereco, c.id, c.endereco);
+        ranking_remover(base, c);
+    }
+}
+
+void registrar_atualizacao(BaseClientes &base, const Cliente &antigo, const Cliente &novo) {
+    registrar_remocao(base, antigo);
+    registrar_insercao(base, novo);
+}
+
+// Interseção de listas de postagens, da menor para a maior: cada ID
+// sobrevivente é procurado por busca binária na lista seguinte
+size_t intersectar_listas(const IndiceTrigramas &indice, const ConjuntoTrigramas &conjunto,
+                          int *&resultado) {
+    resultado = nullptr;
+    if (!indice.listas || conjunto.tamanho == 0) {
+        return 0;
+    }
+
+    size_t menor = 0;
+    for (size_t i = 1; i < conjunto.tamanho; ++i) {
+        if (indice.listas[conjunto.itens[i]].tamanho < indice.listas[conjunto.itens[menor]].tamanho) {
+            menor = i;
+        }
+    }
+    const ListaIds &base_lista = indice.listas[conjunto.itens[menor]];
+    if (base_lista.tamanho == 0) {
+        return 0;
+    }
+    resultado = new (nothrow) int[base_lista.tamanho];
+    if (!resultado) {
+        perror("Falha ao alocar memória");
+        return 0;
+    }
+
+    size_t quantidade = 0;
+    for (uint32_t i = 0; i < base_lista.tamanho; ++i) {
+        int id = base_lista.ids[i];
+        bool presente = true;
+        for (size_t t = 0; t < conjunto.tamanho && presente; ++t) {
+            if (t == menor) {
+                continue;
+            }
+            const ListaIds &lista = indice.listas[conjunto.itens[t]];
+            uint32_t pos = limite_inferior_lista(lista, id);
+            presente = pos < lista.tamanho && lista.ids[pos] == id;
+        }
+        if (presente) {
+            resultado[quantidade++] = id;
+        }
+    }
+    return quantidade;
+}
+
+struct ResultadoAproximado {
+    int id = 0;
+    double similaridade = 0.0;
+};
+
+// Soma, para cada ID, quantos trigramas da consulta ele compartilha,
+// intercalando as listas de postagens já ordenadas
+size_t contar_trigramas_em_comum(const IndiceTrigramas &indice, const ConjuntoTrigramas &conjunto,
+                                 int *&ids, int *&contagens) {
+    ids = nullptr;
+    contagens = nullptr;
+    if (!indice.listas) {
+        return 0;
+    }
+    size_t total = 0;
+    for (size_t t = 0; t < conjunto.tamanho; ++t) {
+        total += indice.listas[conjunto.itens[t]].tamanho;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    ids = new (nothrow) int[total];
+    contagens = new (nothrow) int[total];
+    int *ids_aux = new (nothrow) int[total];
+    int *contagens_aux = new (nothrow) int[total];
+    if (!ids || !contagens || !ids_aux || !contagens_aux) {
+        perror("Falha ao alocar memória");
+        delete[] ids;
+        delete[] contagens;
+        delete[] ids_aux;
+        delete[] contagens_aux;
+        ids = nullptr;
+        contagens = nullptr;
+        return 0;
+    }
+
+    size_t quantidade = 0;
+    for (size_t t = 0; t < conjunto.tamanho; ++t) {
+        const ListaIds &lista = indice.listas[conjunto.itens[t]];
+        size_t i = 0;
+        uint32_t j = 0;
+        size_t n = 0;
+        while (i < quantidade || j < lista.tamanho) {
+            if (j == lista.tamanho || (i < quantidade && ids[i] < lista.ids[j])) {
+                ids_aux[n] = ids[i];
+                contagens_aux[n++] = contagens[i++];
+            } else if (i == quantidade || lista.ids[j] < ids[i]) {
+                ids_aux[n] = lista.ids[j++];
+                contagens_aux[n++] = 1;
+            } else {
+                ids_aux[n] = ids[i];
+                contagens_aux[n++] = contagens[i++] + 1;
+                ++j;
+            }
+        }
+        int *troca = ids;
+        ids = ids_aux;
+        ids_aux = troca;
+        troca = contagens;
+        contagens = contagens_aux;
+        contagens_aux = troca;
+        quantidade = n;
+    }
+
+    delete[] ids_aux;
+    delete[] contagens_aux;
+    return quantidade;
+}
+
+const char *campo_indexado(const Cliente &c, bool por_endereco) {
+    return por_endereco ? c.endereco : c.nome_completo;
+}
+
+// Busca por trecho: candidatos vêm da interseção das listas e são
+// confirmados comparando o texto dobrado
+size_t buscar_trecho(BaseClientes &base, const string &termo, bool por_endereco,
+                     ResultadoAproximado *resultados, size_t maximo) {
+    string consulta = dobrar_texto(termo.c_str());
+    if (consulta.empty() || base.tamanho == 0) {
+        return 0;
+    }
+    ordenar_por_id(base.dados, base.tamanho);
+
+    const IndiceTrigramas &indice = por_endereco ? base.indice_endereco : base.indice_nome;
+    ConjuntoTrigramas conjunto = extrair_trigramas(consulta, false);
+    size_t quantidade = 0;
+
+    if (conjunto.tamanho == 0) {
+        // trecho curto demais para gerar trigramas: varredura direta
+        for (size_t i = 0; i < base.tamanho && quantidade < maximo; ++i) {
+            if (base.dados[i].id > 0 &&
+                dobrar_texto(campo_indexado(base.dados[i], por_endereco)).find(consulta) != string::npos) {
+                resultados[quantidade].id = base.dados[i].id;
+                resultados[quantidade++].similaridade = 1.0;
+            }
+        }
+        return quantidade;
+    }
+
+    int *candidatos = nullptr;
+    size_t total = intersectar_listas(indice, conjunto, candidatos);
+    for (size_t i = 0; i < total && quantidade < maximo; ++i) {
+        int pos = busca_binaria_id(base.dados, base.tamanho, candidatos[i]);
+        if (pos >= 0 &&
+            dobrar_texto(campo_indexado(base.dados[pos], por_endereco)).find(consulta) != string::npos) {
+            resultados[quantidade].id = candidatos[i];
+            resultados[quantidade++].similaridade = 1.0;
+        }
+    }
+    delete[] candidatos;
+    return quantidade;
+}
+
+// Busca aproximada: classifica os candidatos pela similaridade de Jaccard
+// entre os conjuntos de trigramas da consulta e do registro
+size_t buscar_aproximado(BaseClientes &base, const string &termo, bool por_endereco,
+                         ResultadoAproximado *resultados, size_t maximo) {
+    string consulta = dobrar_texto(termo.c_str());
+    if (consulta.empty() || base.tamanho == 0) {
+        return 0;
+    }
+    ordenar_por_id(base.dados, base.tamanho);
+
+    const IndiceTrigramas &indice = por_endereco ? base.indice_endereco : base.indice_nome;
+    ConjuntoTrigramas conjunto = extrair_trigramas(consulta, true);
+    int *ids = nullptr;
+    int *contagens = nullptr;
+    size_t total = contar_trigramas_em_comum(indice, conjunto, ids, contagens);
+
+    size_t quantidade = 0;
+    for (size_t i = 0; i < total; ++i) {
+        // limite superior da similaridade, sem consultar o registro
+        if (static_cast<double>(contagens[i]) / static_cast<double>(conjunto.tamanho) < SIMILARIDADE_MINIMA) {
+            continue;
+        }
+        int pos = busca_binaria_id(base.dados, base.tamanho, ids[i]);
+        if (pos < 0) {
+            continue;
+        }
+        ConjuntoTrigramas do_registro =
+            extrair_trigramas(dobrar_texto(campo_indexado(base.dados[pos], por_endereco)), true);
+        double comum = contagens[i];
+        double similaridade = comum / (static_cast<double>(conjunto.tamanho + do_registro.tamanho) - comum);
+        if (similaridade < SIMILARIDADE_MINIMA) {
+            continue;
+        }
+
+        // mantém os 'maximo' melhores em ordem decrescente (inserção)
+        size_t destino = quantidade < maximo ? quantidade++ : maximo;
+        while (destino > 0 && resultados[destino - 1].similaridade < similaridade) {
+            if (destino < maximo) {
+                resultados[destino] = resultados[destino - 1];
+            }
+            --destino;
+        }
+        if (destino < maximo) {
+            resultados[destino].id = ids[i];
+            resultados[destino].similaridade = similaridade;
+        }
+    }
+
+    delete[] ids;
+    delete[] contagens;
+    return quantidade;
+}
+
+// --------------------------------------------------------------
+// Chaves de colação (ordenação e busca de nomes)
+// --------------------------------------------------------------
+
+// Classe do acento para o ponto de código Latin-1 (0xC0-0xDF, maiúsculas),
+// na ordem usada em português: sem acento < agudo < grave < circunflexo
+// < til < trema < anel < cedilha
+unsigned char classe_acento(unsigned int codigo) {
+    static const unsigned char classes[32] = {
+        2, 1, 3, 4, 5, 6, 0, 7, // À Á Â Ã Ä Å Æ Ç
+        2, 1, 3, 5, 2, 1, 3, 5, // È É Ê Ë Ì Í Î Ï
+        0, 4, 2, 1, 3, 4, 5, 0, // Ð Ñ Ò Ó Ô Õ Ö ×
+        0, 2, 1, 3, 5, 1, 0, 0, // Ø Ù Ú Û Ü Ý Þ ß
+    };
+    return classes[(codigo - 0xC0) & 0x1F];
+}
+
+void gerar_chave_colacao(const char *texto, ChaveColacao &chave) {
+    // buffers reaproveitados entre chamadas (a varredura das consultas
+    // gera uma chave por registro, em várias threads)
+    thread_local string primario;
+    thread_local string secundario;
+    thread_local string terciario;
+    primario.clear();
+    secundario.clear();
+    terciario.clear();
+    for (size_t i = 0; texto[i] != '\0' && primario.size() < MAX_TEXT - 1; ++i) {
+        unsigned char c = static_cast<unsigned char>(texto[i]);
+        char base_letra = ' ';
+        unsigned char acento = 0;
+        bool maiuscula = false;
+        if (isalnum(c) && c < 0x80) {
+            base_letra = static_cast<char>(tolower(c));
+            maiuscula = isupper(c) != 0;
+        } else if (c == 0xC3 && texto[i + 1] != '\0') {
+            unsigned int codigo = 0xC0u + (static_cast<unsigned char>(texto[++i]) & 0x3Fu);
+            base_letra = letra_sem_acento(codigo);
+            maiuscula = codigo < 0xDF;
+            acento = codigo == 0xFF ? 5 : classe_acento(codigo >= 0xE0 ? codigo - 0x20 : codigo);
+        } else if (c >= 0xC0) {
+            while ((static_cast<unsigned char>(texto[i + 1]) & 0xC0u) == 0x80u) {
+                ++i;
+            }
+        }
+
+        if (base_letra == ' ') {
+            if (primario.empty() || primario.back() == ' ') {
+                continue;
+            }
+            maiuscula = false;
+            acento = 0;
+        }
+        primario += base_letra;
+        secundario += static_cast<char>(0x02 + acento);
+        terciario += static_cast<char>(maiuscula ? 0x03 : 0x02);
+    }
+    if (!primario.empty() && primario.back() == ' ') {
+        primario.pop_back();
+        secundario.pop_back();
+        terciario.pop_back();
+    }
+
+    chave.prefixo = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        unsigned char byte = i < primario.size() ? static_cast<unsigned char>(primario[i]) : 0;
+        chave.prefixo = (chave.prefixo << 8) | byte;
+    }
+    chave.completa.assign(primario);
+    chave.completa += '\x01';
+    chave.completa += secundario;
+    chave.completa += '\x01';
+    chave.completa += terciario;
+}
+
+void liberar_cache_colacao(CacheColacao &cache) {
+    delete[] cache.entradas;
+    delete[] cache.ordem_por_nome;
+    cache.entradas = nullptr;
+    cache.ordem_por_nome = nullptr;
+    cache.capacidade = 0;
+    cache.usados = 0;
+    cache.total_ordem = 0;
+    cache.ordem_valida = false;
+}
+
+size_t posicao_inicial_colacao(const CacheColacao &cache, int id) {
+    const uint64_t hash = static_cast<uint64_t>(static_cast<uint32_t>(id)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(hash >> 32) & (cache.capacidade - 1);
+}
+
+// Posição do ID na tabela, ou da primeira posição livre da sua sequência
+size_t sondar_colacao(const CacheColacao &cache, int id) {
+    size_t posicao = posicao_inicial_colacao(cache, id);
+    while (cache.entradas[posicao].id != 0 && cache.entradas[posicao].id != id) {
+        posicao = (posicao + 1) & (cache.capacidade - 1);
+    }
+    return posicao;
+}
+
+// Garante espaço para 'quantidade' chaves com ocupação de no máximo 50%
+bool garantir_capacidade_colacao(CacheColacao &cache, size_t quantidade) {
+    size_t capacidade_alvo = cache.capacidade == 0 ? 64 : cache.capacidade;
+    while (capacidade_alvo < 2 * quantidade) {
+        capacidade_alvo *= 2;
+    }
+    if (capacidade_alvo == cache.capacidade) {
+        return true;
+    }
+    EntradaCacheColacao *novas = new (nothrow) EntradaCacheColacao[capacidade_alvo];
+    if (!novas) {
+        perror("Falha ao alocar memória para as chaves de colação");
+        return false;
+    }
+    EntradaCacheColacao *antigas = cache.entradas;
+    const size_t capacidade_antiga = cache.capacidade;
+    cache.entradas = novas;
+    cache.capacidade = capacidade_alvo;
+    for (size_t i = 0; i < capacidade_antiga; ++i) {
+        if (antigas[i].id != 0) {
+            EntradaCacheColacao &destino = novas[sondar_colacao(cache, antigas[i].id)];
+            destino.id = antigas[i].id;
+            destino.chave.prefixo = antigas[i].chave.prefixo;
+            destino.chave.completa.swap(antigas[i].chave.completa);
+        }
+    }
+    delete[] antigas;
+    return true;
+}
+
+const ChaveColacao *procurar_chave_colacao(const CacheColacao &cache, int id) {
+    if (cache.capacidade == 0) {
+        return nullptr;
+    }
+    const EntradaCacheColacao &entrada = cache.entradas[sondar_colacao(cache, id)];
+    return entrada.id == id ? &entrada.chave : nullptr;
+}
+
+// Devolve a chave em cache do nome do cliente, gerando-a se ainda não
+// existir; nullptr se não houver memória para guardá-la
+const ChaveColacao *obter_chave_nome(BaseClientes &base, const Cliente &c) {
+    CacheColacao &cache = base.colacao_nome;
+    const int id = c.id < 0 ? -c.id : c.id;
+    if (!garantir_capacidade_colacao(cache, cache.usados + 1)) {
+        return nullptr;
+    }
+    EntradaCacheColacao &entrada = cache.entradas[sondar_colacao(cache, id)];
+    if (entrada.id != id) {
+        entrada.id = id;
+        gerar_chave_colacao(c.nome_completo, entrada.chave);
+        cache.usados++;
+    }
+    return &entrada.chave;
+}
+
+// Remove a chave do ID (regerada sob demanda) e invalida a ordem por nome;
+// as entradas seguintes da sequência recuam para não deixar buracos
+void descartar_chave_nome(BaseClientes &base, int id) {
+    CacheColacao &cache = base.colacao_nome;
+    cache.ordem_valida = false;
+    id = id < 0 ? -id : id;
+    if (cache.capacidade == 0 || id == 0) {
+        return;
+    }
+    const size_t mascara = cache.capacidade - 1;
+    size_t livre = sondar_colacao(cache, id);
+    if (cache.entradas[livre].id != id) {
+        return;
+    }
+    size_t atual = livre;
+    for (;;) {
+        atual = (atual + 1) & mascara;
+        EntradaCacheColacao &entrada = cache.entradas[atual];
+        if (entrada.id == 0) {
+            break;
+        }
+        // a entrada só pode recuar se a sua posição inicial não estiver
+        // entre o buraco (exclusive) e ela mesma (inclusive), circularmente
+        const size_t inicial = posicao_inicial_colacao(cache, entrada.id);
+        if (((atual - inicial) & mascara) >= ((atual - livre) & mascara)) {
+            EntradaCacheColacao &buraco = cache.entradas[livre];
+            buraco.id = entrada.id;
+            buraco.chave.prefixo = entrada.chave.prefixo;
+            buraco.chave.completa.swap(entrada.chave.completa);
+            livre = atual;
+        }
+    }
+    cache.entradas[livre].id = 0;
+    cache.entradas[livre].chave.completa.clear();
+    cache.usados--;
+}
+
+// --------------------------------------------------------------
+// CRUD
+// --------------------------------------------------------------
+
+bool existe_documento(const BaseClientes &base, const string &documento) {
+    for (size_t i = 0; i < base.tamanho; ++i) {
+        if (documento == base.dados[i].documento) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Cliente ler_dados_cliente(int id_atribuido) {
+    Cliente c;
+    c.id = id_atribuido;
+    para_cada_campo([&](auto indice) { ler_campo<decltype(indice)::value>(c); });
+    return c;
+}
+
+// Escreve o cartão no fluxo indicado sem forçar descarga a cada linha;
+// quem chama decide quando a tela vai para o terminal
+void imprimir_cartao(ostream &saida, const Cliente &c) {
+    const string borda = "+" + string(LARGURA_CARTAO + 2, '-') + "+\n";
+    string cartao = borda;
+    montar_cartao(cartao, c, make_index_sequence<TOTAL_LINHAS_CARTAO>{});
+    cartao += borda;
+    cartao += '\n';
+    saida << cartao;
+}
+
+void mostrar_trecho(BaseClientes &base, size_t ini, size_t fim) {
+    if (base.tamanho == 0) {
+        cout << "Nenhum cliente cadastrado ainda." << endl << endl;
+        return;
+    }
+
+    if (ini == 0 || ini > fim || fim > base.tamanho) {
+        cout << "Range inválido." << endl << endl;
+        return;
+    }
+
+    ostringstream tela;
+    tela << "Mostrando registros " << ini << " a " << fim << " de " << base.tamanho << "\n\n";
+    for (size_t i = ini - 1; i < fim; ++i) {
+        imprimir_cartao(tela, base.dados[i]);
+    }
+    escrever_tela(tela.str());
+}
+
+void listar_clientes(BaseClientes &base) {
+    if (base.tamanho == 0) {
+        desenhar_banner("Clientes cadastrados");
+        cout << "Nenhum cliente cadastrado ainda." << endl << endl;
+        return;
+    }
+
+    ordenar_por_id(base.dados, base.tamanho);
+    const size_t por_pagina = 10;
+    size_t indice = 0;
+
+    while (indice < base.tamanho) {
+        size_t ate = indice + por_pagina;
+        if (ate > base.tamanho) {
+            ate = base.tamanho;
+        }
+
+        // a página inteira (limpeza, banner e cartões) sai numa única escrita
+        ostringstream tela;
+        desenhar_banner(tela, "Clientes cadastrados");
+        tela << "Mostrando registros " << (indice + 1) << " a " << ate << " de " << base.tamanho << "\n\n";
+        for (size_t i = indice; i < ate; ++i) {
+            imprimir_cartao(tela, base.dados[i]);
+        }
+        escrever_tela(tela.str());
+
+        string opcao = ler_linha("[P]róxima página, [E]ditar ID, [R]emover ID, [N]ovo cadastro, [S]air: ");
+        if (!opcao.empty()) {
+            char acao = static_cast<char>(toupper(static_cast<unsigned char>(opcao[0])));
+            if (acao == 'P') {
+                indice = ate;
+                if (indice >= base.tamanho) {
+                    return;
+                }
+            } else if (acao == 'E') {
+                int id = ler_inteiro("Informe o ID para edição");
+                int pos = encontrar_indice_por_id(base, id);
+                if (pos >= 0) {
+                    manipular_cliente(base, static_cast<size_t>(pos));
+                } else {
+                    cout << endl << "ID não encontrado." << endl << endl;
+                }
+            } else if (acao == 'R') {
+                int id = ler_inteiro("Informe o ID para remoção");
+                int pos = encontrar_indice_por_id(base, id);
+                if (pos >= 0) {
+                    manipular_cliente(base, static_cast<size_t>(pos));
+                } else {
+                    cout << endl << "ID não encontrado." << endl << endl;
+                }
+            } else if (acao == 'N') {
+                inserir_cliente(base);
+            } else {
+                return;
+            }
+        }
+    }
+}
+
+void mostrar_trecho_interativo(BaseClientes &base) {
+    desenhar_banner("Mostrar trecho armazenado");
+    if (base.tamanho == 0) {
+        cout << "Nenhum cliente cadastrado ainda." << endl << endl;
+        return;
     }
 
     int inicio = ler_inteiro("Exibir a partir do registro número");
@@ -607,285 +3469,2992 @@ void mostrar_trecho_interativo(BaseClientes &base) {
         return;
     }
 
-    mostrar_trecho(base, static_cast<size_t>(inicio), static_cast<size_t>(fim));
+    mostrar_trecho(base, static_cast<size_t>(inicio), static_cast<size_t>(fim));
+}
+
+bool inserir_cliente(BaseClientes &base) {
+    desenhar_banner("Novo cadastro de cliente");
+    Cliente novo = ler_dados_cliente(base.proximo_id);
+    if (existe_documento(base, novo.documento)) {
+        cout << endl << "Documento " << novo.documento << " já cadastrado." << endl << endl;
+        return false;
+    }
+
+    if (!garantir_capacidade(base, base.tamanho + 1)) {
+        cerr << endl << "Não há memória suficiente para novos cadastros." << endl << endl;
+        return false;
+    }
+
+    base.dados[base.tamanho++] = novo;
+    base.proximo_id++;
+    registrar_insercao(base, novo);
+    if (!salvar_clientes(base)) {
+        registrar_remocao(base, novo);
+        base.tamanho--;
+        base.proximo_id--;
+        cerr << endl
+             << "Cadastro desfeito: não foi possível salvar por falta de espaço ou erro de gravação." << endl
+             << endl;
+        return false;
+    }
+
+    base.solicitar_salvar = true;
+    cout << endl << "Cliente cadastrado com sucesso!" << endl << endl;
+    return true;
+}
+
+bool atualizar_cliente(BaseClientes &base) {
+    desenhar_banner("Atualizar cliente");
+    int id = ler_inteiro("Informe o ID para atualização");
+    int indice = encontrar_indice_por_id(base, id);
+    if (indice < 0) {
+        cout << endl << "Cliente não encontrado." << endl << endl;
+        return false;
+    }
+
+    cout << endl << "Atualizando registro de " << base.dados[indice].nome_completo << " (ID " << id << ")" << endl;
+    Cliente atualizado = ler_dados_cliente(id);
+
+    for (size_t i = 0; i < base.tamanho; ++i) {
+        bool mesmo_indice = static_cast<int>(i) == indice;
+        if (!mesmo_indice && strcmp(base.dados[i].documento, atualizado.documento) == 0) {
+            cout << endl << "Documento " << atualizado.documento << " já cadastrado em outro cliente." << endl << endl;
+            return false;
+        }
+    }
+
+    registrar_atualizacao(base, base.dados[indice], atualizado);
+    base.dados[indice] = atualizado;
+    if (!salvar_clientes(base)) {
+        return false;
+    }
+
+    base.solicitar_salvar = true;
+    cout << endl << "Registro atualizado com sucesso!" << endl << endl;
+    return true;
+}
+
+bool remover_cliente(BaseClientes &base) {
+    desenhar_banner("Remover cliente");
+    int id = ler_inteiro("Informe o ID para exclusão");
+    int indice = encontrar_indice_por_id(base, id);
+    if (indice < 0) {
+        cout << endl << "Cliente não encontrado." << endl << endl;
+        return false;
+    }
+
+    return escolher_remocao(base, static_cast<size_t>(indice));
+}
+
+bool editar_por_indice(BaseClientes &base, size_t indice) {
+    int id = base.dados[indice].id;
+    cout << endl << "Editando registro de " << base.dados[indice].nome_completo << " (ID " << id << ")" << endl;
+    Cliente atualizado = ler_dados_cliente(id);
+
+    for (size_t i = 0; i < base.tamanho; ++i) {
+        bool mesmo_indice = i == indice;
+        if (!mesmo_indice && strcmp(base.dados[i].documento, atualizado.documento) == 0) {
+            cout << endl << "Documento " << atualizado.documento << " já cadastrado em outro cliente." << endl << endl;
+            return false;
+        }
+    }
+
+    registrar_atualizacao(base, base.dados[indice], atualizado);
+    base.dados[indice] = atualizado;
+    if (!salvar_clientes(base)) {
+        return false;
+    }
+
+    base.solicitar_salvar = true;
+    cout << endl << "Registro atualizado com sucesso!" << endl << endl;
+    return true;
+}
+
+bool remover_por_indice(BaseClientes &base, size_t indice) {
+    cout << endl << "Removendo registro de ID " << base.dados[indice].id << "..." << endl;
+    registrar_remocao(base, base.dados[indice]);
+    for (size_t i = indice; i + 1 < base.tamanho; ++i) {
+        base.dados[i] = base.dados[i + 1];
+    }
+    --base.tamanho;
+    if (!salvar_clientes(base)) {
+        return false;
+    }
+    base.solicitar_salvar = true;
+    cout << endl << "Cliente removido com sucesso!" << endl << endl;
+    return true;
+}
+
+bool remover_logicamente(BaseClientes &base, size_t indice) {
+    cout << endl << "Marcando registro de ID " << base.dados[indice].id << " como removido..." << endl;
+    registrar_remocao(base, base.dados[indice]);
+    base.dados[indice].id = -abs(base.dados[indice].id);
+    base.dados[indice].situacao_cadastral = 'I';
+    base.solicitar_salvar = true;
+    cout << endl << "Registro marcado para remoção. Ele será eliminado fisicamente na próxima gravação." << endl << endl;
+    return true;
+}
+
+bool escolher_remocao(BaseClientes &base, size_t indice) {
+    for (;;) {
+        string opcao = ler_linha("Remover [L]ogicamente, remover [F]isicamente, [V]oltar: ");
+        if (opcao.empty()) {
+            return false;
+        }
+        char acao = static_cast<char>(toupper(static_cast<unsigned char>(opcao[0])));
+        switch (acao) {
+            case 'L':
+                return remover_logicamente(base, indice);
+            case 'F':
+                return remover_por_indice(base, indice);
+            case 'V':
+                return false;
+            default:
+                cout << "Opção inválida. Tente novamente." << endl;
+        }
+    }
+}
+
+bool manipular_cliente(BaseClientes &base, size_t indice) {
+    for (;;) {
+        string opcao = ler_linha("[E]ditar, [R]emover, [N]ovo cadastro, [V]oltar: ");
+        if (opcao.empty()) {
+            return false;
+        }
+        char acao = static_cast<char>(toupper(static_cast<unsigned char>(opcao[0])));
+        switch (acao) {
+            case 'E':
+                return editar_por_indice(base, indice);
+            case 'R':
+                return escolher_remocao(base, indice);
+            case 'N':
+                return inserir_cliente(base);
+            case 'V':
+                return false;
+            default:
+                cout << "Opção inválida. Tente novamente." << endl;
+        }
+    }
+}
+
+void buscar_por_id(BaseClientes &base) {
+    desenhar_banner("Busca por ID");
+    int id = ler_inteiro("Informe o ID para busca");
+    int indice = encontrar_indice_por_id(base, id);
+    if (indice < 0) {
+        cout << endl << "Nenhum cliente com ID " << id << " encontrado." << endl << endl;
+        return;
+    }
+
+    const Cliente &c = base.dados[indice];
+    imprimir_cartao(cout, c);
+    manipular_cliente(base, static_cast<size_t>(indice));
+}
+
+void buscar_por_nome(BaseClientes &base) {
+    desenhar_banner("Busca por nome");
+    string termo = ler_linha("Digite o nome completo para busca exata (acentos e maiúsculas são ignorados)");
+
+    // a ordem por nome vive no cache de colação, em IDs; a posição do
+    // cliente encontrado vem da busca por ID
+    int indice = busca_binaria_nome(base, termo);
+    if (indice < 0) {
+        cout << endl << "Nenhum cliente chamado '" << termo << "' encontrado." << endl << endl;
+        return;
+    }
+
+    imprimir_cartao(cout, base.dados[indice]);
+    manipular_cliente(base, static_cast<size_t>(indice));
+}
+
+void buscar_por_trecho(BaseClientes &base) {
+    desenhar_banner("Busca aproximada por nome ou endereço");
+    char campo = ler_char("Pesquisar em [N]ome ou [E]ndereço");
+    if (campo != 'N' && campo != 'E') {
+        cout << endl << "Campo inválido." << endl << endl;
+        return;
+    }
+    char modo = ler_char("Busca [A]proximada (ranqueada) ou por [T]recho exato");
+    if (modo != 'A' && modo != 'T') {
+        cout << endl << "Modo inválido." << endl << endl;
+        return;
+    }
+    string termo = ler_linha("Digite o termo (acentos e maiúsculas são ignorados)");
+
+    bool por_endereco = campo == 'E';
+    ResultadoAproximado resultados[MAX_RESULTADOS_APROXIMADOS];
+    size_t quantidade = modo == 'A'
+                            ? buscar_aproximado(base, termo, por_endereco, resultados, MAX_RESULTADOS_APROXIMADOS)
+                            : buscar_trecho(base, termo, por_endereco, resultados, MAX_RESULTADOS_APROXIMADOS);
+    if (quantidade == 0) {
+        cout << endl << "Nenhum cliente corresponde a '" << termo << "'." << endl << endl;
+        return;
+    }
+
+    ostringstream tela;
+    tela << "\n" << quantidade << " resultado(s) (máximo de " << MAX_RESULTADOS_APROXIMADOS << ")\n\n";
+    for (size_t i = 0; i < quantidade; ++i) {
+        int pos = busca_binaria_id(base.dados, base.tamanho, resultados[i].id);
+        if (pos < 0) {
+            continue;
+        }
+        if (modo == 'A') {
+            tela << "Similaridade: " << fixed << setprecision(0) << resultados[i].similaridade * 100 << "%\n";
+        }
+        imprimir_cartao(tela, base.dados[pos]);
+    }
+    escrever_tela(tela.str());
+
+    int id = ler_inteiro("Informe o ID para abrir (0 para voltar)");
+    if (id == 0) {
+        return;
+    }
+    int indice = encontrar_indice_por_id(base, id);
+    if (indice < 0) {
+        cout << endl << "ID não encontrado." << endl << endl;
+        return;
+    }
+    manipular_cliente(base, static_cast<size_t>(indice));
+}
+
+void submenu_ordenacao(BaseClientes &base) {
+    bool sair = false;
+    while (!sair) {
+        ostringstream tela;
+        desenhar_banner(tela, "Ordenar e salvar base");
+        tela << "1 - Ordenar por ID e salvar\n";
+        tela << "2 - Ordenar por nome e salvar\n";
+        tela << "0 - Voltar\n";
+        escrever_tela(tela.str());
+
+        int opcao = ler_inteiro("Escolha uma opção");
+        switch (opcao) {
+            case 1:
+                if (salvar_clientes(base, false)) {
+                    base.solicitar_salvar = false;
+                    cout << endl << "Base ordenada por ID e salva." << endl << endl;
+                }
+                pausar();
+                break;
+            case 2:
+                if (salvar_clientes(base, true)) {
+                    base.solicitar_salvar = false;
+                    cout << endl << "Base ordenada por nome e salva." << endl << endl;
+                }
+                pausar();
+                break;
+            case 0:
+                sair = true;
+                break;
+            default:
+                cout << "Opção inválida." << endl;
+                pausar();
+                break;
+        }
+    }
+}
+
+// --------------------------------------------------------------
+// Mesclagem de CSV externo (sort-merge por documento)
+// --------------------------------------------------------------
+
+constexpr const char *CONFLITOS_FILE = "mesclagem_conflitos.txt";
+constexpr size_t CONFLITOS_NA_TELA = 10;
+
+struct ResumoMesclagem {
+    size_t lidas = 0;
+    size_t inseridas = 0;
+    size_t atualizadas = 0;
+    size_t inalteradas = 0;
+    size_t conflitos = 0;
+};
+
+// Retorna a descrição do primeiro campo fora do domínio, ou nullptr
+const char *problema_de_dominio(const Cliente &c) {
+    if (c.documento[0] == '\0') {
+        return "documento vazio";
+    }
+    // "tipo_cliente fora de F/J", montadas uma vez a partir do esquema
+    static const array<string, TOTAL_CAMPOS> mensagens = [] {
+        array<string, TOTAL_CAMPOS> textos;
+        for (size_t i = 0; i < TOTAL_CAMPOS; ++i) {
+            if (ESQUEMA_CLIENTE[i].tipo == TipoCampo::Real) {
+                textos[i] = string(ESQUEMA_CLIENTE[i].nome) + " não é um número finito";
+            }
+            if (ESQUEMA_CLIENTE[i].dominio) {
+                textos[i] = string(ESQUEMA_CLIENTE[i].nome) + " fora de ";
+                for (const char *p = ESQUEMA_CLIENTE[i].dominio; *p; ++p) {
+                    if (p != ESQUEMA_CLIENTE[i].dominio) {
+                        textos[i] += '/';
+                    }
+                    textos[i] += *p;
+                }
+            }
+        }
+        return textos;
+    }();
+    const char *problema = nullptr;
+    para_cada_campo([&](auto indice) {
+        constexpr size_t I = decltype(indice)::value;
+        if (!problema && fora_do_dominio<I>(c)) {
+            problema = mensagens[I].c_str();
+        }
+    });
+    return problema;
+}
+
+bool mesmos_dados(const Cliente &a, const Cliente &b) {
+    return strcmp(a.nome_completo, b.nome_completo) == 0 && strcmp(a.endereco, b.endereco) == 0 &&
+           a.ano_nascimento == b.ano_nascimento && strcmp(a.documento, b.documento) == 0 &&
+           a.tipo_cliente == b.tipo_cliente && a.sexo == b.sexo && a.estado_civil == b.estado_civil &&
+           a.limite_credito == b.limite_credito && a.situacao_cadastral == b.situacao_cadastral;
+}
+
+// Ordena um vetor de posições pelo documento dos registros apontados
+bool ordenar_indices_por_documento(const Cliente *dados, size_t *indices, size_t quantidade) {
+    return ordenar_intercalando(indices, quantidade, [dados](size_t a, size_t b) {
+        return strcmp(dados[a].documento, dados[b].documento) < 0;
+    });
+}
+
+bool ler_arquivo_inteiro(const char *caminho, string &conteudo) {
+    ifstream in(caminho, ios::binary);
+    if (!in) {
+        perror("Não foi possível abrir o arquivo");
+        return false;
+    }
+    in.seekg(0, ios::end);
+    streamoff tamanho = in.tellg();
+    in.seekg(0, ios::beg);
+    if (tamanho < 0) {
+        perror("Não foi possível ler o arquivo");
+        return false;
+    }
+    conteudo.resize(static_cast<size_t>(tamanho));
+    if (tamanho > 0 && !in.read(&conteudo[0], tamanho)) {
+        perror("Falha ao ler o arquivo");
+        return false;
+    }
+    return true;
+}
+
+void registrar_conflito(ofstream &relatorio, ResumoMesclagem &resumo, size_t linha, const char *documento,
+                        const string &motivo) {
+    if (resumo.conflitos < CONFLITOS_NA_TELA) {
+        cout << "  linha " << linha << " (documento " << documento << "): " << motivo << "\n";
+    }
+    if (relatorio) {
+        relatorio << "linha " << linha << ";" << documento << ";" << motivo << "\n";
+    }
+    resumo.conflitos++;
+}
+
+// Insere ou atualiza na base os registros de um CSV externo. O arquivo é
+// lido de uma vez, ordenado por documento e intercalado com a base (também
+// percorrida em ordem de documento); a base é gravada uma única vez ao final.
+bool mesclar_csv(BaseClientes &base, const char *caminho, ResumoMesclagem &resumo) {
+    string conteudo;
+    if (!ler_arquivo_inteiro(caminho, conteudo)) {
+        return false;
+    }
+
+    size_t total_linhas = 1;
+    for (char c : conteudo) {
+        if (c == '\n') {
+            ++total_linhas;
+        }
+    }
+
+    Cliente *entrada = new (nothrow) Cliente[total_linhas];
+    size_t *numero_da_linha = new (nothrow) size_t[total_linhas];
+    size_t *ordem_entrada = new (nothrow) size_t[total_linhas];
+    size_t *ordem_base = new (nothrow) size_t[base.tamanho + 1];
+    if (!entrada || !numero_da_linha || !ordem_entrada || !ordem_base) {
+        perror("Falha ao alocar memória para a mesclagem");
+        delete[] entrada;
+        delete[] numero_da_linha;
+        delete[] ordem_entrada;
+        delete[] ordem_base;
+        return false;
+    }
+
+    ofstream relatorio(CONFLITOS_FILE, ios::trunc);
+    if (!relatorio) {
+        cerr << "Aviso: não foi possível criar " << CONFLITOS_FILE << "; conflitos apenas na tela." << endl;
+    }
+
+    // 1) interpretação e validação das linhas do arquivo
+    size_t validas = 0;
+    const char *cursor = conteudo.data();
+    const char *final_conteudo = conteudo.data() + conteudo.size();
+    for (size_t linha = 1; cursor < final_conteudo; ++linha) {
+        const char *fim = static_cast<const char *>(memchr(cursor, '\n', static_cast<size_t>(final_conteudo - cursor)));
+        if (!fim) {
+            fim = final_conteudo;
+        }
+        bool cabecalho = linha == 1 && fim - cursor >= 3 && memcmp(cursor, "id;", 3) == 0;
+        bool vazia = fim == cursor || (fim - cursor == 1 && *cursor == '\r');
+        if (!cabecalho && !vazia) {
+            resumo.lidas++;
+            Cliente &cli = entrada[validas];
+            // o ID do parceiro não é usado: a coluna pode vir vazia
+            if (!interpretar_linha_csv(cursor, fim, cli, true)) {
+                registrar_conflito(relatorio, resumo, linha, "?", "formato inválido");
+            } else {
+                cli.tipo_cliente = static_cast<char>(toupper(static_cast<unsigned char>(cli.tipo_cliente)));
+                cli.sexo = static_cast<char>(toupper(static_cast<unsigned char>(cli.sexo)));
+                cli.estado_civil = static_cast<char>(toupper(static_cast<unsigned char>(cli.estado_civil)));
+                cli.situacao_cadastral =
+                    static_cast<char>(toupper(static_cast<unsigned char>(cli.situacao_cadastral)));
+                const char *problema = problema_de_dominio(cli);
+                if (problema) {
+                    registrar_conflito(relatorio, resumo, linha, cli.documento, problema);
+                } else {
+                    numero_da_linha[validas] = linha;
+                    ordem_entrada[validas] = validas;
+                    ++validas;
+                }
+            }
+        }
+        cursor = fim + 1;
+    }
+
+    // 2) ordenação das duas sequências por documento
+    compactar_remocoes_logicas(base);
+    ordenar_por_id(base.dados, base.tamanho);
+    const size_t tamanho_original = base.tamanho;
+    for (size_t i = 0; i < tamanho_original; ++i) {
+        ordem_base[i] = i;
+    }
+    bool ok = ordenar_indices_por_documento(entrada, ordem_entrada, validas) &&
+              ordenar_indices_por_documento(base.dados, ordem_base, tamanho_original) &&
+              garantir_capacidade(base, tamanho_original + validas);
+
+    // 3) intercalação: documentos iguais atualizam, os demais são inseridos
+    //    no fim com IDs crescentes, mantendo a base em ordem de ID. Lotes
+    //    grandes reconstroem o índice de trigramas uma vez ao final, em vez
+    //    de deslocar listas de postagens longas a cada registro.
+    base.indices_suspensos = validas > tamanho_original / 16;
+    size_t j = 0;
+    for (size_t i = 0; ok && i < validas; ++i) {
+        const Cliente &novo = entrada[ordem_entrada[i]];
+        if (i > 0 && strcmp(novo.documento, entrada[ordem_entrada[i - 1]].documento) == 0) {
+            registrar_conflito(relatorio, resumo, numero_da_linha[ordem_entrada[i]], novo.documento,
+                               "documento repetido no arquivo (vale a primeira ocorrência)");
+            continue;
+        }
+
+        while (j < tamanho_original && strcmp(base.dados[ordem_base[j]].documento, novo.documento) < 0) {
+            ++j;
+        }
+        if (j < tamanho_original && strcmp(base.dados[ordem_base[j]].documento, novo.documento) == 0) {
+            Cliente &atual = base.dados[ordem_base[j]];
+            Cliente mesclado = novo;
+            mesclado.id = atual.id;
+            if (mesmos_dados(atual, mesclado)) {
+                resumo.inalteradas++;
+            } else {
+                registrar_atualizacao(base, atual, mesclado);
+                atual = mesclado;
+                resumo.atualizadas++;
+            }
+        } else {
+            Cliente mesclado = novo;
+            mesclado.id = base.proximo_id++;
+            base.dados[base.tamanho++] = mesclado;
+            registrar_insercao(base, mesclado);
+            resumo.inseridas++;
+        }
+    }
+
+    delete[] entrada;
+    delete[] numero_da_linha;
+    delete[] ordem_entrada;
+    delete[] ordem_base;
+    if (base.indices_suspensos) {
+        base.indices_suspensos = false;
+        reconstruir_indices(base);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    // 4) gravação única
+    if (resumo.inseridas + resumo.atualizadas == 0) {
+        return true;
+    }
+    base.solicitar_salvar = true;
+    if (!salvar_clientes(base)) {
+        cerr << "As alterações da mesclagem permanecem apenas em memória." << endl;
+        return false;
+    }
+    base.solicitar_salvar = false;
+    return true;
+}
+
+void exibir_resumo_mesclagem(const ResumoMesclagem &resumo, double segundos) {
+    cout << endl
+         << "Linhas lidas: " << resumo.lidas << endl
+         << "Inseridas: " << resumo.inseridas << endl
+         << "Atualizadas: " << resumo.atualizadas << endl
+         << "Sem alteração: " << resumo.inalteradas << endl
+         << "Conflitos: " << resumo.conflitos;
+    if (resumo.conflitos > 0) {
+        cout << " (detalhes em " << CONFLITOS_FILE << ")";
+    }
+    cout << endl << "Tempo: " << fixed << setprecision(2) << segundos << " s" << endl << endl;
+}
+
+void mesclar_csv_interativo(BaseClientes &base) {
+    desenhar_banner("Mesclar CSV externo");
+    string caminho = ler_linha("Caminho do CSV (layout de clientes.csv)");
+    if (caminho.empty()) {
+        return;
+    }
+
+    ResumoMesclagem resumo;
+    auto inicio = chrono::steady_clock::now();
+    bool ok = mesclar_csv(base, caminho.c_str(), resumo);
+    chrono::duration<double> decorrido = chrono::steady_clock::now() - inicio;
+    exibir_resumo_mesclagem(resumo, decorrido.count());
+    cout << (ok ? "Mesclagem concluída." : "Mesclagem interrompida.") << endl << endl;
+}
+
+// --------------------------------------------------------------
+// Exportação para análise (JSON Lines e binário colunar)
+// --------------------------------------------------------------
+
+constexpr char MAGICA_COLUNAR[8] = {'S', 'G', 'C', 'C', 'O', 'L', '0', '1'};
+constexpr uint32_t VERSAO_COLUNAR = 1;
+
+enum class FormatoExportacao { JsonLines, BinarioColunar };
+
+constexpr size_t MAX_FILTROS = 16;
+
+struct FiltroExportacao {
+    size_t coluna = 0;
+    double numero = 0.0;
+    string texto;
+};
+
+struct OpcoesExportacao {
+    FormatoExportacao formato = FormatoExportacao::JsonLines;
+    size_t colunas[TOTAL_CAMPOS]{};
+    size_t total_colunas = 0;
+    FiltroExportacao filtros[MAX_FILTROS];
+    size_t total_filtros = 0;
+    string destino;
+};
+
+int procurar_coluna(const string &nome) {
+    for (size_t i = 0; i < TOTAL_CAMPOS; ++i) {
+        if (nome == ESQUEMA_CLIENTE[i].nome) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Lista separada por vírgulas; vazia seleciona todas as colunas
+bool definir_colunas(OpcoesExportacao &opcoes, const string &lista) {
+    opcoes.total_colunas = 0;
+    if (lista.empty()) {
+        for (size_t i = 0; i < TOTAL_CAMPOS; ++i) {
+            opcoes.colunas[opcoes.total_colunas++] = i;
+        }
+        return true;
+    }
+    size_t inicio = 0;
+    while (inicio <= lista.size()) {
+        size_t fim = lista.find(',', inicio);
+        if (fim == string::npos) {
+            fim = lista.size();
+        }
+        int coluna = procurar_coluna(lista.substr(inicio, fim - inicio));
+        if (coluna < 0 || opcoes.total_colunas == TOTAL_CAMPOS) {
+            cerr << "Coluna inválida: '" << lista.substr(inicio, fim - inicio) << "'" << endl;
+            return false;
+        }
+        opcoes.colunas[opcoes.total_colunas++] = static_cast<size_t>(coluna);
+        inicio = fim + 1;
+    }
+    return true;
+}
+
+// Converte o valor digitado para a coluna: números pelo tipo do campo
+// (o texto inteiro, sem sobras; reais precisam ser finitos), caractere
+// único em maiúscula e texto como veio. Usado pelos filtros da exportação
+// e pelas consultas por expressão.
+bool interpretar_valor_campo(size_t coluna, const string &valor, double &numero, string &texto) {
+    const char *fim = valor.data() + valor.size();
+    switch (ESQUEMA_CLIENTE[coluna].tipo) {
+        case TipoCampo::Inteiro:
+        case TipoCampo::Curto: {
+            long long inteiro = 0;
+            const from_chars_result resultado = from_chars(valor.data(), fim, inteiro);
+            numero = static_cast<double>(inteiro);
+            return resultado.ec == errc() && resultado.ptr == fim;
+        }
+        case TipoCampo::Real: {
+            const from_chars_result resultado = from_chars(valor.data(), fim, numero);
+            return resultado.ec == errc() && resultado.ptr == fim && isfinite(numero);
+        }
+        case TipoCampo::Caractere:
+            texto = string(1, static_cast<char>(toupper(static_cast<unsigned char>(valor.empty() ? '\0' : valor[0]))));
+            return valor.size() == 1;
+        case TipoCampo::Texto:
+            texto = valor;
+            return true;
+    }
+    return false;
+}
+
+// Filtro de igualdade no formato campo=valor
+bool adicionar_filtro(OpcoesExportacao &opcoes, const string &expressao) {
+    size_t igual = expressao.find('=');
+    int coluna = igual == string::npos ? -1 : procurar_coluna(expressao.substr(0, igual));
+    if (coluna < 0 || opcoes.total_filtros == MAX_FILTROS) {
+        cerr << "Filtro inválido: '" << expressao << "' (use campo=valor)" << endl;
+        return false;
+    }
+
+    FiltroExportacao &filtro = opcoes.filtros[opcoes.total_filtros];
+    filtro.coluna = static_cast<size_t>(coluna);
+    if (!interpretar_valor_campo(filtro.coluna, expressao.substr(igual + 1), filtro.numero, filtro.texto)) {
+        cerr << "Valor inválido no filtro: '" << expressao << "'" << endl;
+        return false;
+    }
+    opcoes.total_filtros++;
+    return true;
+}
+
+void anexar_json_texto(string &saida, const char *texto) {
+    saida += '"';
+    for (const char *p = texto; *p; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            saida += '\\';
+            saida += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", c);
+            saida += escape;
+        } else {
+            saida += static_cast<char>(c);
+        }
+    }
+    saida += '"';
+}
+
+template <typename T>
+void anexar_binario(string &saida, const T &valor) {
+    saida.append(reinterpret_cast<const char *>(&valor), sizeof(T));
+}
+
+template <size_t I>
+bool campo_atende(const Cliente &c, const FiltroExportacao &filtro) {
+    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+    const auto *valor = ponteiro_campo<I>(c);
+    if constexpr (campo.tipo == TipoCampo::Texto) {
+        return string_view(valor, strnlen(valor, campo.tamanho)) == filtro.texto;
+    } else if constexpr (campo.tipo == TipoCampo::Caractere) {
+        return *valor == filtro.texto[0];
+    } else if constexpr (campo.tipo == TipoCampo::Real) {
+        return fabs(*valor - filtro.numero) < 0.005;
+    } else {
+        return static_cast<double>(*valor) == filtro.numero;
+    }
+}
+
+template <size_t I>
+void anexar_campo_json(string &saida, const Cliente &c) {
+    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+    saida += '"';
+    saida += campo.nome;
+    saida += "\":";
+    if constexpr (campo.tipo == TipoCampo::Texto || campo.tipo == TipoCampo::Caractere) {
+        string texto;
+        anexar_valor<I>(texto, c);
+        anexar_json_texto(saida, texto.c_str());
+    } else {
+        anexar_valor<I>(saida, c);
+    }
+}
+
+// Coluna I de um bloco colunar. Campos de largura fixa são copiados com
+// memcpy do tamanho do campo; textos gravam (linhas + 1) deslocamentos
+// uint32 e depois o heap de caracteres.
+template <size_t I>
+void anexar_coluna(string &saida, const Cliente *dados, const size_t *selecionados, size_t total) {
+    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+    if constexpr (campo.tipo == TipoCampo::Texto) {
+        uint32_t deslocamento = 0;
+        anexar_binario(saida, deslocamento);
+        for (size_t i = 0; i < total; ++i) {
+            deslocamento += static_cast<uint32_t>(strnlen(ponteiro_campo<I>(dados[selecionados[i]]), campo.tamanho));
+            anexar_binario(saida, deslocamento);
+        }
+        for (size_t i = 0; i < total; ++i) {
+            const char *texto = ponteiro_campo<I>(dados[selecionados[i]]);
+            saida.append(texto, strnlen(texto, campo.tamanho));
+        }
+    } else {
+        const size_t inicio = saida.size();
+        saida.resize(inicio + total * campo.tamanho);
+        char *destino = &saida[inicio];
+        for (size_t i = 0; i < total; ++i) {
+            memcpy(destino + i * campo.tamanho, ponteiro_campo<I>(dados[selecionados[i]]), campo.tamanho);
+        }
+    }
+}
+
+// Operações geradas para cada campo, indexadas pela posição no esquema:
+// a coluna escolhida em tempo de execução vira uma chamada por coluna
+using ComparadorFiltro = bool (*)(const Cliente &, const FiltroExportacao &);
+using FormatadorJson = void (*)(string &, const Cliente &);
+using FormatadorColuna = void (*)(string &, const Cliente *, const size_t *, size_t);
+
+template <typename Sequencia>
+struct OperacoesPorCampo;
+
+template <size_t... I>
+struct OperacoesPorCampo<index_sequence<I...>> {
+    static constexpr ComparadorFiltro filtro[] = {&campo_atende<I>...};
+    static constexpr FormatadorJson json[] = {&anexar_campo_json<I>...};
+    static constexpr FormatadorColuna colunar[] = {&anexar_coluna<I>...};
+};
+
+using OperacoesCampo = OperacoesPorCampo<make_index_sequence<TOTAL_CAMPOS>>;
+
+bool atende_filtros(const Cliente &c, const OpcoesExportacao &opcoes) {
+    if (c.id <= 0) {
+        return false; // removidos logicamente não são exportados
+    }
+    for (size_t i = 0; i < opcoes.total_filtros; ++i) {
+        if (!OperacoesCampo::filtro[opcoes.filtros[i].coluna](c, opcoes.filtros[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void formatar_bloco_json(const Cliente *dados, size_t quantidade, const OpcoesExportacao &opcoes,
+                         string &saida, size_t &linhas) {
+    for (size_t i = 0; i < quantidade; ++i) {
+        const Cliente &c = dados[i];
+        if (!atende_filtros(c, opcoes)) {
+            continue;
+        }
+        saida += '{';
+        for (size_t k = 0; k < opcoes.total_colunas; ++k) {
+            if (k > 0) {
+                saida += ',';
+            }
+            OperacoesCampo::json[opcoes.colunas[k]](saida, c);
+        }
+        saida += "}\n";
+        linhas++;
+    }
+}
+
+// Bloco colunar: quantidade de linhas seguida de cada coluna selecionada,
+// contígua (ordem de bytes do host). Retorna false se faltar memória.
+bool formatar_bloco_colunar(const Cliente *dados, size_t quantidade, const OpcoesExportacao &opcoes,
+                            string &saida, size_t &linhas) {
+    size_t *selecionados = new (nothrow) size_t[quantidade];
+    if (!selecionados) {
+        return false;
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < quantidade; ++i) {
+        if (atende_filtros(dados[i], opcoes)) {
+            selecionados[total++] = i;
+        }
+    }
+    if (total == 0) {
+        delete[] selecionados;
+        return true;
+    }
+
+    anexar_binario(saida, static_cast<uint32_t>(total));
+    for (size_t k = 0; k < opcoes.total_colunas; ++k) {
+        OperacoesCampo::colunar[opcoes.colunas[k]](saida, dados, selecionados, total);
+    }
+    linhas += total;
+    delete[] selecionados;
+    return true;
+}
+
+void escrever_cabecalho_colunar(ofstream &out, const OpcoesExportacao &opcoes, uint64_t linhas, uint64_t blocos) {
+    string cabecalho(MAGICA_COLUNAR, sizeof(MAGICA_COLUNAR));
+    anexar_binario(cabecalho, VERSAO_COLUNAR);
+    anexar_binario(cabecalho, static_cast<uint32_t>(opcoes.total_colunas));
+    anexar_binario(cabecalho, linhas);
+    anexar_binario(cabecalho, blocos);
+    for (size_t k = 0; k < opcoes.total_colunas; ++k) {
+        const DescritorCampo &coluna = ESQUEMA_CLIENTE[opcoes.colunas[k]];
+        anexar_binario(cabecalho, static_cast<uint8_t>(coluna.tipo));
+        anexar_binario(cabecalho, static_cast<uint8_t>(strlen(coluna.nome)));
+        cabecalho += coluna.nome;
+    }
+    out.write(cabecalho.data(), static_cast<streamsize>(cabecalho.size()));
+}
+
+// Exporta a base em blocos de REGISTROS_POR_BLOCO: cada rodada formata
+// vários blocos em paralelo e os grava em ordem, com buffer de escrita grande
+bool exportar_base(BaseClientes &base, const OpcoesExportacao &opcoes, size_t &exportados) {
+    exportados = 0;
+    ordenar_por_id(base.dados, base.tamanho);
+
+    char *buffer_arquivo = new (nothrow) char[BUFFER_ESCRITA];
+    ofstream out;
+    if (buffer_arquivo) {
+        out.rdbuf()->pubsetbuf(buffer_arquivo, BUFFER_ESCRITA);
+    }
+    out.open(opcoes.destino, ios::binary | ios::trunc);
+    if (!out) {
+        perror("Não foi possível abrir o arquivo de exportação");
+        delete[] buffer_arquivo;
+        return false;
+    }
+
+    const bool colunar = opcoes.formato == FormatoExportacao::BinarioColunar;
+    if (colunar) {
+        escrever_cabecalho_colunar(out, opcoes, 0, 0); // reescrito ao final
+    }
+
+    const size_t total_blocos = (base.tamanho + REGISTROS_POR_BLOCO - 1) / REGISTROS_POR_BLOCO;
+    const size_t por_rodada = 2 * quantidade_de_trabalhadores(total_blocos > 0 ? total_blocos : 1);
+    string *buffers = new (nothrow) string[por_rodada];
+    size_t *linhas = new (nothrow) size_t[por_rodada];
+    if (!buffers || !linhas) {
+        perror("Falha ao alocar memória para exportação");
+        delete[] buffers;
+        delete[] linhas;
+        out.close();
+        delete[] buffer_arquivo;
+        return false;
+    }
+
+    uint64_t blocos_gravados = 0;
+    atomic<bool> sem_memoria{false};
+    for (size_t primeiro = 0; primeiro < total_blocos && out && !sem_memoria; primeiro += por_rodada) {
+        size_t nesta_rodada = total_blocos - primeiro < por_rodada ? total_blocos - primeiro : por_rodada;
+        executar_em_paralelo(nesta_rodada, [&](size_t b) {
+            size_t inicio = (primeiro + b) * REGISTROS_POR_BLOCO;
+            size_t quantidade = base.tamanho - inicio < REGISTROS_POR_BLOCO ? base.tamanho - inicio : REGISTROS_POR_BLOCO;
+            buffers[b].clear();
+            linhas[b] = 0;
+            if (colunar) {
+                if (!formatar_bloco_colunar(base.dados + inicio, quantidade, opcoes, buffers[b], linhas[b])) {
+                    sem_memoria = true;
+                }
+            } else {
+                formatar_bloco_json(base.dados + inicio, quantidade, opcoes, buffers[b], linhas[b]);
+            }
+        });
+        for (size_t b = 0; b < nesta_rodada; ++b) {
+            out.write(buffers[b].data(), static_cast<streamsize>(buffers[b].size()));
+            exportados += linhas[b];
+            if (linhas[b] > 0) {
+                blocos_gravados++;
+            }
+        }
+    }
+    delete[] buffers;
+    delete[] linhas;
+
+    if (sem_memoria) {
+        // um bloco ficou de fora: o arquivo está incompleto e não vale
+        out.close();
+        delete[] buffer_arquivo;
+        remove(opcoes.destino.c_str());
+        cerr << "Falha ao alocar memória para exportação; o arquivo não foi gerado." << endl;
+        return false;
+    }
+    if (colunar && out) {
+        out.seekp(0, ios::beg);
+        escrever_cabecalho_colunar(out, opcoes, exportados, blocos_gravados);
+    }
+    out.flush();
+    bool ok = static_cast<bool>(out);
+    out.close();
+    delete[] buffer_arquivo;
+    if (!ok) {
+        perror("Falha ao gravar exportação");
+    }
+    return ok;
+}
+
+void exportar_interativo(BaseClientes &base) {
+    desenhar_banner("Exportar para análise");
+    OpcoesExportacao opcoes;
+
+    char formato = ler_char("Formato: [J]SON Lines ou [B]inário colunar");
+    if (formato != 'J' && formato != 'B') {
+        cout << endl << "Formato inválido." << endl << endl;
+        return;
+    }
+    opcoes.formato = formato == 'B' ? FormatoExportacao::BinarioColunar : FormatoExportacao::JsonLines;
+
+    cout << "Colunas disponíveis:";
+    for (size_t i = 0; i < TOTAL_CAMPOS; ++i) {
+        cout << ' ' << ESQUEMA_CLIENTE[i].nome;
+    }
+    cout << endl;
+    if (!definir_colunas(opcoes, ler_linha("Colunas separadas por vírgula (ENTER para todas)"))) {
+        return;
+    }
+
+    for (;;) {
+        string filtro = ler_linha("Filtro campo=valor (ENTER para encerrar)");
+        if (filtro.empty()) {
+            break;
+        }
+        adicionar_filtro(opcoes, filtro);
+    }
+
+    opcoes.destino = ler_linha("Arquivo de destino");
+    if (opcoes.destino.empty()) {
+        opcoes.destino = opcoes.formato == FormatoExportacao::BinarioColunar ? "clientes.col" : "clientes.jsonl";
+    }
+
+    size_t exportados = 0;
+    auto inicio = chrono::steady_clock::now();
+    if (exportar_base(base, opcoes, exportados)) {
+        chrono::duration<double> decorrido = chrono::steady_clock::now() - inicio;
+        cout << endl << exportados << " registro(s) exportado(s) para " << opcoes.destino << " em " << fixed
+             << setprecision(2) << decorrido.count() << " s." << endl << endl;
+    }
+}
+
+// --------------------------------------------------------------
+// Verificação e reparo dos arquivos de dados
+// --------------------------------------------------------------
+
+constexpr const char *REJEITADOS_FILE = "clientes.rejeitados.csv";
+constexpr size_t EXEMPLOS_POR_PROBLEMA = 5;
+constexpr size_t MAX_SHARDS = static_cast<size_t>(numeric_limits<int>::max()) / IDS_POR_SHARD + 1;
+
+enum TipoProblema {
+    PROBLEMA_ARQUIVO,
+    PROBLEMA_CAUDA_TRUNCADA,
+    PROBLEMA_ORDEM,
+    PROBLEMA_ID_INVALIDO,
+    PROBLEMA_ID_FORA_DA_FAIXA,
+    PROBLEMA_ID_DUPLICADO,
+    PROBLEMA_DOCUMENTO_DUPLICADO,
+    PROBLEMA_TEXTO_SEM_TERMINADOR,
+    PROBLEMA_DOMINIO,
+    PROBLEMA_CONTADORES,
+    TOTAL_PROBLEMAS
+};
+
+const char *const NOMES_PROBLEMAS[TOTAL_PROBLEMAS] = {
+    "arquivos inválidos ou ausentes",
+    "cauda truncada",
+    "registros fora de ordem",
+    "IDs nulos ou negativos",
+    "IDs fora da faixa do shard",
+    "IDs duplicados",
+    "documentos duplicados",
+    "textos sem terminador",
+    "campos fora do domínio",
+    "contadores do manifesto divergentes",
+};
+
+// Contagem por tipo de problema e os primeiros exemplos de cada um
+struct RelatorioVerificacao {
+    size_t contagem[TOTAL_PROBLEMAS] = {};
+    string exemplos[TOTAL_PROBLEMAS];
+};
+
+void anotar_problema(RelatorioVerificacao &relatorio, TipoProblema tipo, const string &detalhe) {
+    if (relatorio.contagem[tipo]++ < EXEMPLOS_POR_PROBLEMA) {
+        relatorio.exemplos[tipo] += "    " + detalhe + "\n";
+    }
+}
+
+void juntar_relatorios(RelatorioVerificacao &destino, const RelatorioVerificacao &origem) {
+    for (size_t t = 0; t < TOTAL_PROBLEMAS; ++t) {
+        size_t exemplos = destino.contagem[t] < EXEMPLOS_POR_PROBLEMA ? destino.contagem[t] : EXEMPLOS_POR_PROBLEMA;
+        size_t inicio = 0;
+        while (exemplos < EXEMPLOS_POR_PROBLEMA && inicio < origem.exemplos[t].size()) {
+            size_t fim = origem.exemplos[t].find('\n', inicio) + 1;
+            destino.exemplos[t].append(origem.exemplos[t], inicio, fim - inicio);
+            inicio = fim;
+            exemplos++;
+        }
+        destino.contagem[t] += origem.contagem[t];
+    }
+}
+
+size_t total_de_problemas(const RelatorioVerificacao &relatorio) {
+    size_t total = 0;
+    for (size_t t = 0; t < TOTAL_PROBLEMAS; ++t) {
+        total += relatorio.contagem[t];
+    }
+    return total;
+}
+
+// Arquivo com registros a percorrer: um shard ou o arquivo no formato antigo
+struct ArquivoVerificado {
+    string caminho;
+    uint64_t deslocamento = 0; // bytes de cabeçalho antes dos registros
+    uint64_t registros = 0;
+    bool com_faixa = false;
+    int id_inicial = 0;
+    int id_final = 0;
+    uint32_t ordem = ORDEM_POR_ID;
+    size_t primeiro = 0; // índice global do primeiro registro
+};
+
+// Trecho de um arquivo verificado por uma tarefa
+struct BlocoVerificacao {
+    size_t arquivo = 0;
+    uint64_t inicio = 0;
+    uint64_t quantidade = 0;
+    RelatorioVerificacao relatorio;
+    ResumoBase resumo;
+    int primeiro_id = 0;
+    int ultimo_id = 0;
+    ChaveColacao primeira_chave;
+    ChaveColacao ultima_chave;
+    size_t mantidos = 0;
+};
+
+struct EntradaIdVerificada {
+    int id;
+    uint32_t global;
+};
+
+struct EntradaDocumentoVerificada {
+    uint64_t hash;
+    uint32_t global;
+};
+
+// Estado completo de uma verificação; 'descartar' marca, por índice
+// global, os registros que o reparo não leva para a base nova
+struct Verificacao {
+    ArquivoVerificado *arquivos = nullptr;
+    size_t total_arquivos = 0;
+    size_t total_registros = 0;
+    bool *shard_em_disco = nullptr; // por índice de shard encontrado no diretório
+    bool *shard_invalido = nullptr; // cabeçalho ilegível: o reparo o renomeia
+    bool manifesto_valido = false;
+    bool resumo_no_manifesto = false;
+    ResumoBase resumo_manifesto;
+    RelatorioVerificacao relatorio;
+    bool *descartar = nullptr;
+    size_t mantidos = 0;
+};
+
+void liberar_verificacao(Verificacao &v) {
+    delete[] v.arquivos;
+    delete[] v.shard_em_disco;
+    delete[] v.shard_invalido;
+    delete[] v.descartar;
+    v.arquivos = nullptr;
+    v.shard_em_disco = nullptr;
+    v.shard_invalido = nullptr;
+    v.descartar = nullptr;
+}
+
+uint64_t hash_documento(const char *documento) {
+    uint64_t hash = 1469598103934665603ull; // FNV-1a
+    for (size_t i = 0; i < sizeof(Cliente::documento) && documento[i] != '\0'; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(documento[i])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+bool chave_colacao_menor(const ChaveColacao &a, const ChaveColacao &b) {
+    if (a.prefixo != b.prefixo) {
+        return a.prefixo < b.prefixo;
+    }
+    return a.completa < b.completa;
+}
+
+// Índice do shard pelo nome "clientes.dat.NNNN"; -1 para outros arquivos
+long long indice_do_arquivo_de_shard(const string &nome) {
+    const string prefixo = string(DATA_FILE) + ".";
+    if (nome.size() <= prefixo.size() || nome.compare(0, prefixo.size(), prefixo) != 0) {
+        return -1;
+    }
+    const char *inicio = nome.data() + prefixo.size();
+    const char *fim = nome.data() + nome.size();
+    size_t indice = 0;
+    const from_chars_result resultado = from_chars(inicio, fim, indice);
+    if (resultado.ec != errc() || resultado.ptr != fim || indice >= MAX_SHARDS) {
+        return -1;
+    }
+    return static_cast<long long>(indice);
+}
+
+bool adicionar_arquivo_verificado(Verificacao &v, size_t &capacidade, const ArquivoVerificado &arquivo) {
+    if (v.total_arquivos == capacidade) {
+        size_t capacidade_alvo = capacidade == 0 ? 16 : capacidade * 2;
+        ArquivoVerificado *novos = new (nothrow) ArquivoVerificado[capacidade_alvo];
+        if (!novos) {
+            perror("Falha ao alocar memória para a verificação");
+            return false;
+        }
+        for (size_t i = 0; i < v.total_arquivos; ++i) {
+            novos[i] = v.arquivos[i];
+        }
+        delete[] v.arquivos;
+        v.arquivos = novos;
+        capacidade = capacidade_alvo;
+    }
+    v.arquivos[v.total_arquivos++] = arquivo;
+    return true;
+}
+
+// Confere o cabeçalho e o tamanho de um shard e o inclui na varredura
+bool incluir_shard(Verificacao &v, size_t &capacidade, size_t indice, uint64_t registros_no_manifesto,
+                   bool listado) {
+    const string caminho = caminho_do_shard(indice);
+    char detalhe[160];
+    ifstream in(caminho, ios::binary);
+    CabecalhoShard cab{};
+    if (!in || !in.read(reinterpret_cast<char *>(&cab), sizeof(cab)) ||
+        memcmp(cab.magica, MAGICA_SHARD, sizeof(MAGICA_SHARD)) != 0 || cab.indice != indice ||
+        cab.tamanho_registro != sizeof(Cliente)) {
+        if (listado && registros_no_manifesto == 0 && !in.is_open()) {
+            return true; // esvaziado numa gravação interrompida: nada a verificar
+        }
+        anotar_problema(v.relatorio, PROBLEMA_ARQUIVO, caminho + ": ausente ou com cabeçalho inválido");
+        v.shard_invalido[indice] = in.is_open();
+        return true;
+    }
+    if (!listado) {
+        anotar_problema(v.relatorio, PROBLEMA_ARQUIVO, caminho + ": não listado no manifesto");
+    } else if (cab.registros != registros_no_manifesto) {
+        snprintf(detalhe, sizeof(detalhe), "%s: manifesto indica %llu registro(s), cabeçalho indica %llu",
+                 caminho.c_str(), static_cast<unsigned long long>(registros_no_manifesto),
+                 static_cast<unsigned long long>(cab.registros));
+        anotar_problema(v.relatorio, PROBLEMA_ARQUIVO, detalhe);
+    }
+
+    const uint64_t bytes = tamanho_do_arquivo(caminho.c_str());
+    const uint64_t disponiveis = bytes > sizeof(CabecalhoShard) ? bytes - sizeof(CabecalhoShard) : 0;
+    ArquivoVerificado arquivo;
+    arquivo.caminho = caminho;
+    arquivo.deslocamento = sizeof(CabecalhoShard);
+    arquivo.registros = cab.registros;
+    if (disponiveis < cab.registros * sizeof(Cliente)) {
+        arquivo.registros = disponiveis / sizeof(Cliente);
+        snprintf(detalhe, sizeof(detalhe), "%s: %llu de %llu registro(s) presentes", caminho.c_str(),
+                 static_cast<unsigned long long>(arquivo.registros), static_cast<unsigned long long>(cab.registros));
+        anotar_problema(v.relatorio, PROBLEMA_CAUDA_TRUNCADA, detalhe);
+    } else if (disponiveis > cab.registros * sizeof(Cliente)) {
+        snprintf(detalhe, sizeof(detalhe), "%s: %llu byte(s) além do último registro", caminho.c_str(),
+                 static_cast<unsigned long long>(disponiveis - cab.registros * sizeof(Cliente)));
+        anotar_problema(v.relatorio, PROBLEMA_ARQUIVO, detalhe);
+    }
+    arquivo.com_faixa = true;
+    arquivo.id_inicial = cab.id_inicial;
+    arquivo.id_final = cab.id_final;
+    arquivo.ordem = cab.ordem;
+    return adicionar_arquivo_verificado(v, capacidade, arquivo);
+}
+
+// Monta a lista de arquivos a percorrer: shards do manifesto, shards
+// encontrados no diretório e ausentes do manifesto, ou o arquivo antigo
+bool listar_arquivos_de_dados(Verificacao &v) {
+    v.shard_em_disco = new (nothrow) bool[MAX_SHARDS]();
+    v.shard_invalido = new (nothrow) bool[MAX_SHARDS]();
+    if (!v.shard_em_disco || !v.shard_invalido) {
+        perror("Falha ao alocar memória para a verificação");
+        return false;
+    }
+    try {
+        for (const auto &entrada : std::filesystem::directory_iterator(std::filesystem::current_path())) {
+            long long indice = indice_do_arquivo_de_shard(entrada.path().filename().string());
+            if (indice >= 0 && entrada.is_regular_file()) {
+                v.shard_em_disco[indice] = true;
+            }
+        }
+    } catch (const std::exception &e) {
+        cerr << "Aviso: não foi possível listar o diretório: " << e.what() << endl;
+    }
+
+    size_t capacidade = 0;
+    bool *listados = new (nothrow) bool[MAX_SHARDS]();
+    if (!listados) {
+        perror("Falha ao alocar memória para a verificação");
+        return false;
+    }
+    bool ok = true;
+    ifstream in(DATA_FILE, ios::binary);
+    CabecalhoManifesto cabecalho{};
+    if (!in) {
+        anotar_problema(v.relatorio, PROBLEMA_ARQUIVO, string(DATA_FILE) + ": manifesto ausente");
+    } else if (!ler_cabecalho_manifesto(in, cabecalho)) {
+        // formato antigo: registros contíguos, sem cabeçalho
+        const uint64_t bytes = tamanho_do_arquivo(DATA_FILE);
+        ArquivoVerificado arquivo;
+        arquivo.caminho = DATA_FILE;
+        arquivo.registros = bytes / sizeof(Cliente);
+        if (bytes % sizeof(Cliente) != 0) {
+            char detalhe[128];
+            snprintf(detalhe, sizeof(detalhe), "%s: %llu byte(s) de um registro incompleto no final", DATA_FILE,
+                     static_cast<unsigned long long>(bytes % sizeof(Cliente)));
+            anotar_problema(v.relatorio, PROBLEMA_CAUDA_TRUNCADA, detalhe);
+        }
+        ok = adicionar_arquivo_verificado(v, capacidade, arquivo);
+    } else if (cabecalho.versao < VERSAO_SEM_RESUMO || cabecalho.versao > VERSAO_ARMAZENAMENTO ||
+               cabecalho.tamanho_registro != sizeof(Cliente) || cabecalho.ids_por_shard == 0) {
+        anotar_problema(v.relatorio, PROBLEMA_ARQUIVO, string(DATA_FILE) + ": versão ou layout incompatível");
+    } else {
+        v.manifesto_valido = true;
+        v.resumo_no_manifesto =
+            cabecalho.versao >= 2 &&
+            static_cast<bool>(in.read(reinterpret_cast<char *>(&v.resumo_manifesto), sizeof(ResumoBase)));
+        for (uint64_t s = 0; ok && s < cabecalho.total_shards; ++s) {
+            EntradaManifesto entrada{};
+            if (!in.read(reinterpret_cast<char *>(&entrada), sizeof(entrada))) {
+                anotar_problema(v.relatorio, PROBLEMA_ARQUIVO, string(DATA_FILE) + ": lista de shards truncada");
+                break;
+            }
+            if (entrada.indice >= MAX_SHARDS || listados[entrada.indice]) {
+                anotar_problema(v.relatorio, PROBLEMA_ARQUIVO, string(DATA_FILE) + ": entrada de shard inválida");
+                continue;
+            }
+            listados[entrada.indice] = true;
+            ok = incluir_shard(v, capacidade, static_cast<size_t>(entrada.indice), entrada.registros, true);
+        }
+    }
+    for (size_t indice = 0; ok && indice < MAX_SHARDS; ++indice) {
+        if (v.shard_em_disco[indice] && !listados[indice]) {
+            ok = incluir_shard(v, capacidade, indice, 0, false);
+        }
+    }
+    delete[] listados;
+
+    for (size_t i = 0; i < v.total_arquivos; ++i) {
+        v.arquivos[i].primeiro = v.total_registros;
+        v.total_registros += static_cast<size_t>(v.arquivos[i].registros);
+    }
+    if (v.total_registros > numeric_limits<uint32_t>::max()) {
+        cerr << "Quantidade de registros acima do suportado pela verificação." << endl;
+        return false;
+    }
+    return ok;
+}
+
+bool ler_registros(const ArquivoVerificado &arquivo, uint64_t inicio, uint64_t quantidade, Cliente *destino) {
+    ifstream in(arquivo.caminho, ios::binary);
+    in.seekg(static_cast<streamoff>(arquivo.deslocamento + inicio * sizeof(Cliente)), ios::beg);
+    return static_cast<bool>(
+        in.read(reinterpret_cast<char *>(destino), static_cast<streamsize>(quantidade * sizeof(Cliente))));
+}
+
+bool ler_registro_global(const Verificacao &v, size_t global, Cliente &c) {
+    size_t esquerda = 0;
+    size_t direita = v.total_arquivos;
+    while (direita - esquerda > 1) {
+        size_t meio = esquerda + (direita - esquerda) / 2;
+        if (v.arquivos[meio].primeiro <= global) {
+            esquerda = meio;
+        } else {
+            direita = meio;
+        }
+    }
+    const ArquivoVerificado &arquivo = v.arquivos[esquerda];
+    return ler_registros(arquivo, global - arquivo.primeiro, 1, &c);
+}
+
+ChaveColacao chave_do_registro(const Cliente &c) {
+    char nome[MAX_TEXT];
+    copiar_campo(nome, c.nome_completo, c.nome_completo + strnlen(c.nome_completo, MAX_TEXT), MAX_TEXT);
+    ChaveColacao chave;
+    gerar_chave_colacao(nome, chave);
+    return chave;
+}
+
+// Verifica um trecho de arquivo: terminadores, IDs, domínios e ordem
+// local; os IDs e documentos vão para os vetores globais
+void verificar_bloco(Verificacao &v, BlocoVerificacao &bloco, Cliente *registros, EntradaIdVerificada *ids,
+                     EntradaDocumentoVerificada *documentos) {
+    const ArquivoVerificado &arquivo = v.arquivos[bloco.arquivo];
+    if (!ler_registros(arquivo, bloco.inicio, bloco.quantidade, registros)) {
+        anotar_problema(bloco.relatorio, PROBLEMA_ARQUIVO, arquivo.caminho + ": falha de leitura");
+        for (uint64_t i = 0; i < bloco.quantidade; ++i) {
+            const size_t global = arquivo.primeiro + static_cast<size_t>(bloco.inicio + i);
+            v.descartar[global] = true;
+            ids[global] = {0, static_cast<uint32_t>(global)};
+            documentos[global] = {0, static_cast<uint32_t>(global)};
+        }
+        bloco.quantidade = 0;
+        return;
+    }
+
+    const bool por_nome = arquivo.ordem == ORDEM_POR_NOME;
+    ChaveColacao anterior;
+    char detalhe[192];
+    for (uint64_t i = 0; i < bloco.quantidade; ++i) {
+        const Cliente &c = registros[i];
+        const size_t global = arquivo.primeiro + static_cast<size_t>(bloco.inicio + i);
+        bool descartado = false;
+
+        para_cada_campo([&](auto indice) {
+            constexpr DescritorCampo campo = ESQUEMA_CLIENTE[decltype(indice)::value];
+            if constexpr (campo.tipo == TipoCampo::Texto) {
+                if (!memchr(ponteiro_campo<decltype(indice)::value>(c), '\0', campo.tamanho)) {
+                    snprintf(detalhe, sizeof(detalhe), "%s, registro %zu (ID %d): %s", arquivo.caminho.c_str(),
+                             global - arquivo.primeiro, c.id, campo.nome);
+                    anotar_problema(bloco.relatorio, PROBLEMA_TEXTO_SEM_TERMINADOR, detalhe);
+                }
+            }
+        });
+        if (c.id <= 0) {
+            snprintf(detalhe, sizeof(detalhe), "%s, registro %zu: ID %d", arquivo.caminho.c_str(),
+                     global - arquivo.primeiro, c.id);
+            anotar_problema(bloco.relatorio, PROBLEMA_ID_INVALIDO, detalhe);
+            descartado = true;
+        } else {
+            if (arquivo.com_faixa && (c.id < arquivo.id_inicial || c.id > arquivo.id_final)) {
+                snprintf(detalhe, sizeof(detalhe), "%s: ID %d fora de [%d, %d]", arquivo.caminho.c_str(), c.id,
+                         arquivo.id_inicial, arquivo.id_final);
+                anotar_problema(bloco.relatorio, PROBLEMA_ID_FORA_DA_FAIXA, detalhe);
+            }
+            const char *problema = problema_de_dominio(c);
+            if (problema) {
+                snprintf(detalhe, sizeof(detalhe), "ID %d: %s", c.id, problema);
+                anotar_problema(bloco.relatorio, PROBLEMA_DOMINIO, detalhe);
+                descartado = true;
+            }
+        }
+
+        if (por_nome) {
+            ChaveColacao chave = chave_do_registro(c);
+            if (i > 0 && chave_colacao_menor(chave, anterior)) {
+                snprintf(detalhe, sizeof(detalhe), "%s: ID %d antes do ID %d na ordem por nome",
+                         arquivo.caminho.c_str(), registros[i - 1].id, c.id);
+                anotar_problema(bloco.relatorio, PROBLEMA_ORDEM, detalhe);
+            }
+            if (i == 0) {
+                bloco.primeira_chave = chave;
+            }
+            anterior = move(chave);
+        } else if (i > 0 && c.id < registros[i - 1].id) {
+            snprintf(detalhe, sizeof(detalhe), "%s: ID %d depois do ID %d", arquivo.caminho.c_str(), c.id,
+                     registros[i - 1].id);
+            anotar_problema(bloco.relatorio, PROBLEMA_ORDEM, detalhe);
+        }
+
+        contabilizar_cliente(bloco.resumo, c, true);
+        v.descartar[global] = descartado;
+        ids[global] = {c.id, static_cast<uint32_t>(global)};
+        documentos[global] = {hash_documento(c.documento), static_cast<uint32_t>(global)};
+    }
+    if (bloco.quantidade > 0) {
+        bloco.primeiro_id = registros[0].id;
+        bloco.ultimo_id = registros[bloco.quantidade - 1].id;
+        bloco.ultima_chave = move(anterior);
+    }
+}
+
+// IDs repetidos entre os registros mantidos: fica a primeira ocorrência
+void verificar_ids_duplicados(Verificacao &v, EntradaIdVerificada *ids) {
+    size_t quantidade = 0;
+    for (size_t i = 0; i < v.total_registros; ++i) {
+        if (!v.descartar[i]) {
+            ids[quantidade++] = ids[i];
+        }
+    }
+    ordenar_intercalando(ids, quantidade,
+                         [](const EntradaIdVerificada &a, const EntradaIdVerificada &b) { return a.id < b.id; });
+    for (size_t i = 1; i < quantidade; ++i) {
+        if (ids[i].id == ids[i - 1].id) {
+            anotar_problema(v.relatorio, PROBLEMA_ID_DUPLICADO, "ID " + to_string(ids[i].id) + " repetido");
+            v.descartar[ids[i].global] = true;
+        }
+    }
+}
+
+// Documentos repetidos: agrupados pelo hash e confirmados relendo os
+// registros do disco; fica o primeiro de cada documento
+void verificar_documentos_duplicados(Verificacao &v, EntradaDocumentoVerificada *documentos) {
+    size_t quantidade = 0;
+    for (size_t i = 0; i < v.total_registros; ++i) {
+        if (!v.descartar[documentos[i].global]) {
+            documentos[quantidade++] = documentos[i];
+        }
+    }
+    ordenar_intercalando(documentos, quantidade,
+                         [](const EntradaDocumentoVerificada &a, const EntradaDocumentoVerificada &b) {
+                             return a.hash < b.hash;
+                         });
+    for (size_t inicio = 0; inicio < quantidade;) {
+        size_t fim = inicio + 1;
+        while (fim < quantidade && documentos[fim].hash == documentos[inicio].hash) {
+            ++fim;
+        }
+        for (size_t i = inicio + 1; i < fim; ++i) {
+            Cliente atual{};
+            if (!ler_registro_global(v, documentos[i].global, atual)) {
+                continue;
+            }
+            for (size_t j = inicio; j < i; ++j) {
+                Cliente anterior{};
+                if (v.descartar[documentos[j].global] || !ler_registro_global(v, documentos[j].global, anterior)) {
+                    continue;
+                }
+                if (strncmp(atual.documento, anterior.documento, sizeof(atual.documento)) == 0) {
+                    char detalhe[160];
+                    snprintf(detalhe, sizeof(detalhe), "documento %.*s nos IDs %d e %d",
+                             static_cast<int>(strnlen(atual.documento, sizeof(atual.documento))), atual.documento,
+                             anterior.id, atual.id);
+                    anotar_problema(v.relatorio, PROBLEMA_DOCUMENTO_DUPLICADO, detalhe);
+                    v.descartar[documentos[i].global] = true;
+                    break;
+                }
+            }
+        }
+        inicio = fim;
+    }
+}
+
+// Primeiro contador em que o manifesto e a contagem dos arquivos diferem,
+// com os dois valores; vazio quando todos coincidem
+string diferenca_de_contadores(const ResumoBase &manifesto, const ResumoBase &arquivos) {
+    const auto valores = [](const char *rotulo, auto de_manifesto, auto de_arquivos) {
+        return string(rotulo) + ": manifesto " + to_string(de_manifesto) + ", arquivos " + to_string(de_arquivos);
+    };
+    if (manifesto.total != arquivos.total) {
+        return valores("total", manifesto.total, arquivos.total);
+    }
+    const char *const situacoes[] = {"por_situacao[A]", "por_situacao[I]", "por_situacao[outros]"};
+    const char *const tipos[] = {"por_tipo[F]", "por_tipo[J]", "por_tipo[outros]"};
+    for (size_t k = 0; k < 3; ++k) {
+        if (manifesto.por_situacao[k] != arquivos.por_situacao[k]) {
+            return valores(situacoes[k], manifesto.por_situacao[k], arquivos.por_situacao[k]);
+        }
+    }
+    for (size_t k = 0; k < 3; ++k) {
+        if (manifesto.por_tipo[k] != arquivos.por_tipo[k]) {
+            return valores(tipos[k], manifesto.por_tipo[k], arquivos.por_tipo[k]);
+        }
+    }
+    const char *const estados[] = {"por_estado_civil[S]", "por_estado_civil[C]", "por_estado_civil[V]",
+                                   "por_estado_civil[D]", "por_estado_civil[outros]"};
+    for (size_t k = 0; k < 5; ++k) {
+        if (manifesto.por_estado_civil[k] != arquivos.por_estado_civil[k]) {
+            return valores(estados[k], manifesto.por_estado_civil[k], arquivos.por_estado_civil[k]);
+        }
+    }
+    if (manifesto.soma_limites_centavos != arquivos.soma_limites_centavos) {
+        return valores("soma_limites_centavos", manifesto.soma_limites_centavos, arquivos.soma_limites_centavos);
+    }
+    return "";
+}
+
+// Percorre todos os arquivos em blocos paralelos e preenche o relatório
+bool verificar_arquivos(Verificacao &v) {
+    if (!listar_arquivos_de_dados(v)) {
+        return false;
+    }
+
+    size_t total_blocos = 0;
+    for (size_t a = 0; a < v.total_arquivos; ++a) {
+        total_blocos += static_cast<size_t>((v.arquivos[a].registros + REGISTROS_POR_BLOCO - 1) / REGISTROS_POR_BLOCO);
+    }
+    BlocoVerificacao *blocos = new (nothrow) BlocoVerificacao[total_blocos + 1];
+    EntradaIdVerificada *ids = new (nothrow) EntradaIdVerificada[v.total_registros + 1];
+    EntradaDocumentoVerificada *documentos = new (nothrow) EntradaDocumentoVerificada[v.total_registros + 1];
+    v.descartar = new (nothrow) bool[v.total_registros + 1]();
+    if (!blocos || !ids || !documentos || !v.descartar) {
+        perror("Falha ao alocar memória para a verificação");
+        delete[] blocos;
+        delete[] ids;
+        delete[] documentos;
+        return false;
+    }
+    size_t b = 0;
+    for (size_t a = 0; a < v.total_arquivos; ++a) {
+        for (uint64_t inicio = 0; inicio < v.arquivos[a].registros; inicio += REGISTROS_POR_BLOCO) {
+            blocos[b].arquivo = a;
+            blocos[b].inicio = inicio;
+            blocos[b].quantidade = v.arquivos[a].registros - inicio < REGISTROS_POR_BLOCO
+                                       ? v.arquivos[a].registros - inicio
+                                       : REGISTROS_POR_BLOCO;
+            ++b;
+        }
+    }
+
+    atomic<bool> sem_memoria{false};
+    executar_em_paralelo(total_blocos, [&](size_t indice) {
+        Cliente *registros = new (nothrow) Cliente[blocos[indice].quantidade];
+        if (!registros) {
+            sem_memoria = true;
+            return;
+        }
+        verificar_bloco(v, blocos[indice], registros, ids, documentos);
+        delete[] registros;
+    });
+    if (sem_memoria) {
+        perror("Falha ao alocar memória para a verificação");
+        delete[] blocos;
+        delete[] ids;
+        delete[] documentos;
+        return false;
+    }
+
+    // ordem nas fronteiras entre blocos do mesmo arquivo
+    ResumoBase resumo;
+    for (size_t i = 0; i < total_blocos; ++i) {
+        juntar_relatorios(v.relatorio, blocos[i].relatorio);
+        if (i > 0 && blocos[i].arquivo == blocos[i - 1].arquivo && blocos[i].quantidade > 0 &&
+            blocos[i - 1].quantidade > 0) {
+            const bool por_nome = v.arquivos[blocos[i].arquivo].ordem == ORDEM_POR_NOME;
+            if (por_nome ? chave_colacao_menor(blocos[i].primeira_chave, blocos[i - 1].ultima_chave)
+                         : blocos[i].primeiro_id < blocos[i - 1].ultimo_id) {
+                anotar_problema(v.relatorio, PROBLEMA_ORDEM,
+                                v.arquivos[blocos[i].arquivo].caminho + ": ID " + to_string(blocos[i].primeiro_id) +
+                                    " depois do ID " + to_string(blocos[i - 1].ultimo_id));
+            }
+        }
+        resumo.total += blocos[i].resumo.total;
+        for (size_t k = 0; k < 3; ++k) {
+            resumo.por_situacao[k] += blocos[i].resumo.por_situacao[k];
+            resumo.por_tipo[k] += blocos[i].resumo.por_tipo[k];
+        }
+        for (size_t k = 0; k < 5; ++k) {
+            resumo.por_estado_civil[k] += blocos[i].resumo.por_estado_civil[k];
+        }
+        resumo.soma_limites_centavos += blocos[i].resumo.soma_limites_centavos;
+    }
+    delete[] blocos;
+    if (v.resumo_no_manifesto) {
+        const string diferenca = diferenca_de_contadores(v.resumo_manifesto, resumo);
+        if (!diferenca.empty()) {
+            anotar_problema(v.relatorio, PROBLEMA_CONTADORES, diferenca);
+        }
+    }
+
+    verificar_ids_duplicados(v, ids);
+    verificar_documentos_duplicados(v, documentos);
+    delete[] ids;
+    delete[] documentos;
+
+    v.mantidos = 0;
+    for (size_t i = 0; i < v.total_registros; ++i) {
+        v.mantidos += !v.descartar[i];
+    }
+    return true;
+}
+
+void exibir_relatorio_verificacao(const Verificacao &v, double segundos) {
+    const double megabytes = static_cast<double>(v.total_registros * sizeof(Cliente)) / (1024.0 * 1024.0);
+    cout << "Verificação de " << DATA_FILE << ": " << v.total_registros << " registro(s) em " << v.total_arquivos
+         << " arquivo(s), " << fixed << setprecision(1) << megabytes << " MiB em " << setprecision(2) << segundos
+         << " s (" << setprecision(0) << (segundos > 0 ? megabytes / segundos : 0.0) << " MiB/s)" << endl;
+    if (total_de_problemas(v.relatorio) == 0) {
+        cout << "Nenhum problema encontrado." << endl;
+        return;
+    }
+    for (size_t t = 0; t < TOTAL_PROBLEMAS; ++t) {
+        if (v.relatorio.contagem[t] > 0) {
+            cout << "  " << NOMES_PROBLEMAS[t] << ": " << v.relatorio.contagem[t] << endl << v.relatorio.exemplos[t];
+        }
+    }
+    cout << v.total_registros - v.mantidos << " registro(s) seriam descartados por um reparo." << endl;
+}
+
+// Regrava a base só com os registros mantidos: textos sem terminador são
+// truncados, IDs fora da faixa vão para o shard certo e os descartados
+// são preservados em REJEITADOS_FILE
+bool reparar_arquivos(Verificacao &v) {
+    BaseClientes base;
+    base.indices_suspensos = true;
+    if (!garantir_capacidade(base, v.mantidos + 1)) {
+        return false;
+    }
+    ofstream rejeitados(REJEITADOS_FILE, ios::binary | ios::trunc);
+    if (!rejeitados) {
+        perror("Não foi possível criar o arquivo de rejeitados");
+        destruir_base(base);
+        return false;
+    }
+    rejeitados << CABECALHO_CSV;
+
+    Cliente *registros = new (nothrow) Cliente[REGISTROS_POR_BLOCO];
+    if (!registros) {
+        perror("Falha ao alocar memória para o reparo");
+        destruir_base(base);
+        return false;
+    }
+    string linhas;
+    for (size_t a = 0; a < v.total_arquivos; ++a) {
+        const ArquivoVerificado &arquivo = v.arquivos[a];
+        for (uint64_t inicio = 0; inicio < arquivo.registros; inicio += REGISTROS_POR_BLOCO) {
+            const uint64_t quantidade =
+                arquivo.registros - inicio < REGISTROS_POR_BLOCO ? arquivo.registros - inicio : REGISTROS_POR_BLOCO;
+            if (!ler_registros(arquivo, inicio, quantidade, registros)) {
+                continue; // trecho ilegível: já descartado na verificação
+            }
+            linhas.clear();
+            for (uint64_t i = 0; i < quantidade; ++i) {
+                Cliente &c = registros[i];
+                para_cada_campo([&](auto indice) {
+                    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[decltype(indice)::value];
+                    if constexpr (campo.tipo == TipoCampo::Texto) {
+                        ponteiro_campo<decltype(indice)::value>(c)[campo.tamanho - 1] = '\0';
+                    }
+                });
+                if (v.descartar[arquivo.primeiro + static_cast<size_t>(inicio + i)]) {
+                    formatar_linha_csv(linhas, c);
+                } else {
+                    base.dados[base.tamanho++] = c;
+                }
+            }
+            rejeitados.write(linhas.data(), static_cast<streamsize>(linhas.size()));
+        }
+    }
+    delete[] registros;
+    rejeitados.close();
+
+    // todos os shards são regravados; os que sobrarem vazios são apagados
+    // e os ilegíveis são apenas renomeados, para inspeção manual
+    bool ok = garantir_capacidade_shards(base.shards, MAX_SHARDS);
+    for (size_t indice = 0; ok && indice < MAX_SHARDS; ++indice) {
+        base.shards.em_disco[indice] = v.shard_em_disco[indice] && !v.shard_invalido[indice];
+        if (v.shard_invalido[indice]) {
+            const string caminho = caminho_do_shard(indice);
+            if (rename(caminho.c_str(), (caminho + ".invalido").c_str()) != 0) {
+                perror("Não foi possível renomear o shard inválido");
+                ok = false;
+            }
+        }
+    }
+    if (ok) {
+        base.shards.todos_sujos = true;
+        base.espelho_csv.completo = true;
+        recalcular_resumo(base);
+        ok = salvar_clientes(base);
+    }
+    if (ok) {
+        cout << "Base reparada: " << base.tamanho << " registro(s) mantido(s), "
+             << v.total_registros - v.mantidos << " descartado(s) em " << REJEITADOS_FILE << "." << endl;
+    }
+    destruir_base(base);
+    return ok;
+}
+
+// --------------------------------------------------------------
+// Consultas avulsas direto dos arquivos (sgc get)
+// --------------------------------------------------------------
+
+// Arquivo aberto somente para leitura; com mmap, só as páginas tocadas
+// pela busca são lidas do disco
+struct ArquivoMapeado {
+    const char *dados = nullptr;
+    size_t tamanho = 0;
+};
+
+bool mapear_arquivo(const string &caminho, ArquivoMapeado &arquivo) {
+    #ifdef _WIN32
+    ifstream in(caminho, ios::binary | ios::ate);
+    if (!in) {
+        return false;
+    }
+    arquivo.tamanho = static_cast<size_t>(in.tellg());
+    char *dados = new (nothrow) char[arquivo.tamanho + 1];
+    in.seekg(0, ios::beg);
+    if (!dados || !in.read(dados, static_cast<streamsize>(arquivo.tamanho))) {
+        delete[] dados;
+        return false;
+    }
+    arquivo.dados = dados;
+    return true;
+    #else
+    int descritor = open(caminho.c_str(), O_RDONLY);
+    if (descritor < 0) {
+        return false;
+    }
+    struct stat info {};
+    bool ok = fstat(descritor, &info) == 0;
+    arquivo.tamanho = ok ? static_cast<size_t>(info.st_size) : 0;
+    if (ok && arquivo.tamanho > 0) {
+        void *endereco = mmap(nullptr, arquivo.tamanho, PROT_READ, MAP_PRIVATE, descritor, 0);
+        ok = endereco != MAP_FAILED;
+        arquivo.dados = ok ? static_cast<const char *>(endereco) : nullptr;
+    }
+    close(descritor);
+    return ok;
+    #endif
+}
+
+void desmapear_arquivo(ArquivoMapeado &arquivo) {
+    #ifdef _WIN32
+    delete[] arquivo.dados;
+    #else
+    if (arquivo.dados) {
+        munmap(const_cast<char *>(arquivo.dados), arquivo.tamanho);
+    }
+    #endif
+    arquivo.dados = nullptr;
+    arquivo.tamanho = 0;
 }
 
-bool inserir_cliente(BaseClientes &base) {
-    desenhar_banner("Novo cadastro de cliente");
-    Cliente novo = ler_dados_cliente(base.proximo_id);
-    if (existe_documento(base, novo.documento)) {
-        cout << endl << "Documento " << novo.documento << " já cadastrado." << endl << endl;
+// Shard mapeado, com o cabeçalho validado e os registros presentes
+struct ShardMapeado {
+    ArquivoMapeado arquivo;
+    CabecalhoShard cabecalho{};
+    const Cliente *registros = nullptr;
+    size_t quantidade = 0;
+};
+
+bool mapear_shard(size_t indice, ShardMapeado &shard) {
+    if (!mapear_arquivo(caminho_do_shard(indice), shard.arquivo)) {
         return false;
     }
-
-    if (!garantir_capacidade(base, base.tamanho + 1)) {
-        cerr << endl << "Não há memória suficiente para novos cadastros." << endl << endl;
+    if (shard.arquivo.tamanho < sizeof(CabecalhoShard)) {
+        return false;
+    }
+    memcpy(&shard.cabecalho, shard.arquivo.dados, sizeof(CabecalhoShard));
+    const CabecalhoShard &cab = shard.cabecalho;
+    if (memcmp(cab.magica, MAGICA_SHARD, sizeof(MAGICA_SHARD)) != 0 || cab.indice != indice ||
+        cab.tamanho_registro != sizeof(Cliente)) {
         return false;
     }
+    const size_t disponiveis = (shard.arquivo.tamanho - sizeof(CabecalhoShard)) / sizeof(Cliente);
+    shard.quantidade = cab.registros < disponiveis ? static_cast<size_t>(cab.registros) : disponiveis;
+    shard.registros = reinterpret_cast<const Cliente *>(shard.arquivo.dados + sizeof(CabecalhoShard));
+    return true;
+}
 
-    base.dados[base.tamanho++] = novo;
-    base.proximo_id++;
-    if (!salvar_clientes(base)) {
-        base.tamanho--;
-        base.proximo_id--;
-        cerr << endl
-             << "Cadastro desfeito: não foi possível salvar por falta de espaço ou erro de gravação." << endl
-             << endl;
+// Posição do ID no shard: busca binária na ordem por ID, varredura linear
+// quando o shard foi gravado em ordem de nome
+int posicao_no_shard(const ShardMapeado &shard, int id) {
+    if (shard.cabecalho.ordem == ORDEM_POR_ID) {
+        return busca_binaria_id(shard.registros, shard.quantidade, id);
+    }
+    for (size_t i = 0; i < shard.quantidade; ++i) {
+        if (shard.registros[i].id == id) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Primeiro registro com o documento, varrendo os registros em sequência
+int posicao_do_documento(const Cliente *registros, size_t quantidade, const char *documento) {
+    for (size_t i = 0; i < quantidade; ++i) {
+        if (registros[i].id > 0 && strncmp(registros[i].documento, documento, sizeof(Cliente::documento)) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Procura o documento pelo índice do shard. Sem índice da mesma gravação
+// do shard (soma diferente, base de uma versão anterior), ou se nenhuma
+// entrada do índice for confirmada pelo registro, o shard é varrido.
+int buscar_documento_no_shard(size_t indice, const ShardMapeado &shard, const char *documento) {
+    ArquivoMapeado arquivo;
+    CabecalhoIndiceDocumento cab{};
+    bool indice_valido =
+        mapear_arquivo(caminho_do_shard(indice) + SUFIXO_INDICE_DOCUMENTO, arquivo) && arquivo.tamanho >= sizeof(cab);
+    if (indice_valido) {
+        memcpy(&cab, arquivo.dados, sizeof(cab));
+        indice_valido = memcmp(cab.magica, MAGICA_INDICE_DOCUMENTO, sizeof(MAGICA_INDICE_DOCUMENTO)) == 0 &&
+                        cab.indice == indice && cab.tamanho_entrada == sizeof(EntradaIndiceDocumento) &&
+                        cab.registros == shard.cabecalho.registros && shard.cabecalho.soma_registros != 0 &&
+                        cab.soma_registros == shard.cabecalho.soma_registros &&
+                        arquivo.tamanho - sizeof(cab) >= cab.registros * sizeof(EntradaIndiceDocumento);
+    }
+    if (!indice_valido) {
+        desmapear_arquivo(arquivo);
+        return posicao_do_documento(shard.registros, shard.quantidade, documento);
+    }
+
+    EntradaIndiceDocumento procurada{};
+    preencher_chave_documento(procurada.documento, documento);
+    const EntradaIndiceDocumento *entradas =
+        reinterpret_cast<const EntradaIndiceDocumento *>(arquivo.dados + sizeof(cab));
+    size_t inicio = 0;
+    size_t fim = static_cast<size_t>(cab.registros);
+    while (inicio < fim) {
+        size_t meio = inicio + (fim - inicio) / 2;
+        if (documento_menor(entradas[meio], procurada)) {
+            inicio = meio + 1;
+        } else {
+            fim = meio;
+        }
+    }
+    // o índice aponta o ID; o registro confirma o documento
+    int posicao = -1;
+    bool desmentido = false;
+    for (size_t i = inicio; posicao < 0 && i < cab.registros && !documento_menor(procurada, entradas[i]); ++i) {
+        int candidato = posicao_no_shard(shard, entradas[i].id);
+        if (candidato >= 0 && strncmp(shard.registros[candidato].documento, documento, sizeof(Cliente::documento)) == 0) {
+            posicao = candidato;
+        } else {
+            desmentido = true;
+        }
+    }
+    desmapear_arquivo(arquivo);
+    return posicao < 0 && desmentido ? posicao_do_documento(shard.registros, shard.quantidade, documento) : posicao;
+}
+
+// Lista de shards do manifesto, sem ler os registros
+bool ler_lista_de_shards(ifstream &in, const CabecalhoManifesto &cabecalho, EntradaManifesto *&entradas) {
+    if (cabecalho.versao < VERSAO_SEM_RESUMO || cabecalho.versao > VERSAO_ARMAZENAMENTO ||
+        cabecalho.tamanho_registro != sizeof(Cliente) || cabecalho.ids_por_shard == 0) {
+        cerr << "Arquivo de dados em formato incompatível." << endl;
+        return false;
+    }
+    if (cabecalho.versao >= 2) {
+        in.seekg(sizeof(ResumoBase), ios::cur);
+    }
+    entradas = new (nothrow) EntradaManifesto[cabecalho.total_shards + 1];
+    if (!entradas) {
+        perror("Falha ao alocar memória para o manifesto");
+        return false;
+    }
+    if (!in.read(reinterpret_cast<char *>(entradas),
+                 static_cast<streamsize>(cabecalho.total_shards * sizeof(EntradaManifesto)))) {
+        cerr << "Manifesto de dados truncado." << endl;
         return false;
     }
+    return true;
+}
 
-    base.solicitar_salvar = true;
-    cout << endl << "Cliente cadastrado com sucesso!" << endl << endl;
+enum class ResultadoConsulta { Encontrado, Ausente, Erro };
+
+// Localiza um cliente por ID (documento vazio) ou por documento. Com o
+// manifesto, só o shard da faixa do ID (ou os índices de documento) é
+// aberto; no formato antigo, o arquivo inteiro é mapeado e varrido.
+ResultadoConsulta consultar_arquivos(int id, const char *documento, Cliente &encontrado) {
+    ifstream in(DATA_FILE, ios::binary);
+    if (!in) {
+        cerr << "Arquivo de dados " << DATA_FILE << " não encontrado." << endl;
+        return ResultadoConsulta::Erro;
+    }
+    CabecalhoManifesto cabecalho{};
+    if (!ler_cabecalho_manifesto(in, cabecalho)) {
+        in.close();
+        ArquivoMapeado arquivo;
+        if (!mapear_arquivo(DATA_FILE, arquivo)) {
+            perror("Não foi possível abrir o arquivo de dados");
+            return ResultadoConsulta::Erro;
+        }
+        const Cliente *registros = reinterpret_cast<const Cliente *>(arquivo.dados);
+        const size_t quantidade = arquivo.tamanho / sizeof(Cliente);
+        int posicao = -1;
+        if (*documento != '\0') {
+            posicao = posicao_do_documento(registros, quantidade, documento);
+        } else {
+            for (size_t i = 0; posicao < 0 && i < quantidade; ++i) {
+                if (registros[i].id == id) {
+                    posicao = static_cast<int>(i);
+                }
+            }
+        }
+        if (posicao >= 0) {
+            encontrado = registros[posicao];
+        }
+        desmapear_arquivo(arquivo);
+        return posicao >= 0 ? ResultadoConsulta::Encontrado : ResultadoConsulta::Ausente;
+    }
+
+    EntradaManifesto *entradas = nullptr;
+    if (!ler_lista_de_shards(in, cabecalho, entradas)) {
+        delete[] entradas;
+        return ResultadoConsulta::Erro;
+    }
+    ResultadoConsulta resultado = ResultadoConsulta::Ausente;
+    for (uint64_t s = 0; resultado == ResultadoConsulta::Ausente && s < cabecalho.total_shards; ++s) {
+        const size_t indice = static_cast<size_t>(entradas[s].indice);
+        if (entradas[s].registros == 0 ||
+            (*documento == '\0' && (id <= 0 || indice != shard_do_id(id, cabecalho.ids_por_shard)))) {
+            continue;
+        }
+        ShardMapeado shard;
+        if (!mapear_shard(indice, shard)) {
+            cerr << "Shard " << caminho_do_shard(indice) << " ausente ou inválido." << endl;
+            resultado = ResultadoConsulta::Erro;
+        } else {
+            int posicao = *documento != '\0' ? buscar_documento_no_shard(indice, shard, documento)
+                                             : posicao_no_shard(shard, id);
+            if (posicao >= 0) {
+                encontrado = shard.registros[posicao];
+                resultado = ResultadoConsulta::Encontrado;
+            }
+        }
+        desmapear_arquivo(shard.arquivo);
+    }
+    delete[] entradas;
+    return resultado;
+}
+
+// Anexa o registro como objeto JSON ou linha CSV (sem cabeçalho)
+void formatar_registro(string &saida, const Cliente &c, bool json) {
+    if (!json) {
+        formatar_linha_csv(saida, c);
+        return;
+    }
+    saida += '{';
+    para_cada_campo([&](auto indice) {
+        constexpr size_t I = decltype(indice)::value;
+        if constexpr (I > 0) {
+            saida += ',';
+        }
+        anexar_campo_json<I>(saida, c);
+    });
+    saida += "}\n";
+}
+
+void imprimir_consulta(const Cliente &c, bool json) {
+    string saida = json ? "" : CABECALHO_CSV;
+    formatar_registro(saida, c, json);
+    cout << saida;
+}
+
+// --------------------------------------------------------------
+// Consultas por expressão (filtros, ordenação e limite)
+// --------------------------------------------------------------
+
+// Exemplo: situacao=A and tipo=J and limite>=20000
+//          and ano between 1950 and 1970 order by limite desc limit 50
+constexpr size_t MAX_PREDICADOS = 16;
+constexpr size_t MAX_TERMOS = 4 * MAX_PREDICADOS + 8;
+constexpr size_t LOTE_RANKING = 4096;
+constexpr double CUSTO_ACESSO_ALEATORIO = 4.0; // por candidato vindo do ranking
+constexpr size_t RESULTADOS_POR_PAGINA = 10;
+
+// Nomes curtos aceitos além dos nomes do esquema
+struct ApelidoCampo {
+    const char *apelido;
+    const char *campo;
+};
+
+const ApelidoCampo APELIDOS_CAMPOS[] = {
+    {"nome", "nome_completo"}, {"ano", "ano_nascimento"}, {"doc", "documento"}, {"tipo", "tipo_cliente"},
+    {"estado", "estado_civil"}, {"limite", "limite_credito"}, {"situacao", "situacao_cadastral"},
+};
+
+enum class OperadorConsulta { Igual, Diferente, Menor, MenorIgual, Maior, MaiorIgual, Entre };
+
+struct PredicadoConsulta {
+    size_t campo = 0;
+    OperadorConsulta operador = OperadorConsulta::Igual;
+    double numero[2] = {}; // campos numéricos
+    string texto[2];       // textos (nível primário da colação) e caracteres (em maiúscula)
+};
+
+struct Consulta {
+    PredicadoConsulta predicados[MAX_PREDICADOS];
+    size_t total_predicados = 0;
+    int campo_ordem = -1; // -1: ordem de ID
+    bool decrescente = false;
+    size_t limite = 0; // 0: sem limite
+};
+
+enum class CaminhoAcesso { FaixaDeId, Ranking, VarreduraParalela };
+
+// Caminho escolhido e a estimativa que o justificou
+struct PlanoConsulta {
+    CaminhoAcesso caminho = CaminhoAcesso::VarreduraParalela;
+    double custo = 0.0;
+    size_t inicio = 0; // faixa de ID: posições [inicio, fim) na base
+    size_t fim = 0;
+    size_t segmento = SEGMENTO_TODOS; // ranking: árvore e faixa de limite
+    float limite_minimo = 0.0f;
+    float limite_maximo = 0.0f;
+    size_t posicao_inicial = 0;
+    size_t candidatos = 0;
+    bool ja_ordenado = false; // o ranking já entrega a ordem pedida
+};
+
+// Posições (em base.dados) dos registros selecionados
+struct SelecaoConsulta {
+    size_t *posicoes = nullptr;
+    size_t quantidade = 0;
+    size_t capacidade = 0;
+};
+
+void liberar_selecao(SelecaoConsulta &selecao) {
+    delete[] selecao.posicoes;
+    selecao.posicoes = nullptr;
+    selecao.quantidade = 0;
+    selecao.capacidade = 0;
+}
+
+bool anexar_posicao(SelecaoConsulta &selecao, size_t posicao) {
+    if (selecao.quantidade == selecao.capacidade) {
+        size_t capacidade_alvo = selecao.capacidade == 0 ? 64 : selecao.capacidade * 2;
+        size_t *novas = new (nothrow) size_t[capacidade_alvo];
+        if (!novas) {
+            perror("Falha ao alocar memória para a consulta");
+            return false;
+        }
+        if (selecao.quantidade > 0) {
+            memcpy(novas, selecao.posicoes, selecao.quantidade * sizeof(size_t));
+        }
+        delete[] selecao.posicoes;
+        selecao.posicoes = novas;
+        selecao.capacidade = capacidade_alvo;
+    }
+    selecao.posicoes[selecao.quantidade++] = posicao;
     return true;
 }
 
-bool atualizar_cliente(BaseClientes &base) {
-    desenhar_banner("Atualizar cliente");
-    int id = ler_inteiro("Informe o ID para atualização");
-    int indice = encontrar_indice_por_id(base, id);
-    if (indice < 0) {
-        cout << endl << "Cliente não encontrado." << endl << endl;
-        return false;
+int procurar_campo_consulta(const string &nome) {
+    for (const ApelidoCampo &apelido : APELIDOS_CAMPOS) {
+        if (nome == apelido.apelido) {
+            return procurar_coluna(apelido.campo);
+        }
     }
+    return procurar_coluna(nome);
+}
 
-    cout << endl << "Atualizando registro de " << base.dados[indice].nome_completo << " (ID " << id << ")" << endl;
-    Cliente atualizado = ler_dados_cliente(id);
+// Compara o campo I com o valor k do predicado: negativo, zero ou positivo
+template <size_t I>
+int comparar_com_valor(const Cliente &c, const PredicadoConsulta &p, size_t k) {
+    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+    const auto *valor = ponteiro_campo<I>(c);
+    if constexpr (campo.tipo == TipoCampo::Texto) {
+        // sem acentos nem caixa, como na busca por nome; a chave é
+        // reaproveitada por thread para não alocar a cada registro
+        thread_local ChaveColacao chave;
+        gerar_chave_colacao(valor, chave);
+        return chave.completa.compare(0, chave.completa.find('\x01'), p.texto[k]);
+    } else if constexpr (campo.tipo == TipoCampo::Caractere) {
+        return static_cast<unsigned char>(*valor) - static_cast<unsigned char>(p.texto[k][0]);
+    } else if constexpr (campo.tipo == TipoCampo::Real) {
+        const double diferenca = static_cast<double>(*valor) - p.numero[k];
+        return fabs(diferenca) < 0.005 ? 0 : diferenca < 0 ? -1 : 1;
+    } else {
+        const double numero = static_cast<double>(*valor);
+        return (numero > p.numero[k]) - (numero < p.numero[k]);
+    }
+}
 
-    for (size_t i = 0; i < base.tamanho; ++i) {
-        bool mesmo_indice = static_cast<int>(i) == indice;
-        if (!mesmo_indice && strcmp(base.dados[i].documento, atualizado.documento) == 0) {
-            cout << endl << "Documento " << atualizado.documento << " já cadastrado em outro cliente." << endl << endl;
+template <size_t I>
+bool predicado_atende(const Cliente &c, const PredicadoConsulta &p) {
+    switch (p.operador) {
+        case OperadorConsulta::Igual: return comparar_com_valor<I>(c, p, 0) == 0;
+        case OperadorConsulta::Diferente: return comparar_com_valor<I>(c, p, 0) != 0;
+        case OperadorConsulta::Menor: return comparar_com_valor<I>(c, p, 0) < 0;
+        case OperadorConsulta::MenorIgual: return comparar_com_valor<I>(c, p, 0) <= 0;
+        case OperadorConsulta::Maior: return comparar_com_valor<I>(c, p, 0) > 0;
+        case OperadorConsulta::MaiorIgual: return comparar_com_valor<I>(c, p, 0) >= 0;
+        default: return comparar_com_valor<I>(c, p, 0) >= 0 && comparar_com_valor<I>(c, p, 1) <= 0;
+    }
+}
+
+template <size_t I>
+bool campo_menor(const Cliente &a, const Cliente &b) {
+    constexpr DescritorCampo campo = ESQUEMA_CLIENTE[I];
+    if constexpr (campo.tipo == TipoCampo::Texto) {
+        return strncmp(ponteiro_campo<I>(a), ponteiro_campo<I>(b), campo.tamanho) < 0;
+    } else {
+        return *ponteiro_campo<I>(a) < *ponteiro_campo<I>(b);
+    }
+}
+
+using AvaliadorPredicado = bool (*)(const Cliente &, const PredicadoConsulta &);
+using ComparadorCampo = bool (*)(const Cliente &, const Cliente &);
+
+template <typename Sequencia>
+struct OperacoesDeConsulta;
+
+template <size_t... I>
+struct OperacoesDeConsulta<index_sequence<I...>> {
+    static constexpr AvaliadorPredicado predicado[] = {&predicado_atende<I>...};
+    static constexpr ComparadorCampo menor[] = {&campo_menor<I>...};
+};
+
+using OperacoesConsulta = OperacoesDeConsulta<make_index_sequence<TOTAL_CAMPOS>>;
+
+bool atende_consulta(const Cliente &c, const Consulta &consulta) {
+    if (c.id <= 0) {
+        return false; // removidos logicamente ficam fora das consultas
+    }
+    for (size_t i = 0; i < consulta.total_predicados; ++i) {
+        const PredicadoConsulta &p = consulta.predicados[i];
+        if (!OperacoesConsulta::predicado[p.campo](c, p)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct TermoConsulta {
+    string texto;
+    bool literal = false; // entre aspas: nunca é operador nem palavra-chave
+};
+
+// Divide a expressão em nomes, valores, operadores e textos entre aspas
+bool separar_termos(const string &expressao, TermoConsulta *termos, size_t &total) {
+    total = 0;
+    size_t i = 0;
+    while (i < expressao.size()) {
+        const char c = expressao[i];
+        if (isspace(static_cast<unsigned char>(c))) {
+            ++i;
+            continue;
+        }
+        if (total == MAX_TERMOS) {
+            cerr << "Expressão longa demais." << endl;
             return false;
         }
+        TermoConsulta &termo = termos[total++];
+        termo = TermoConsulta{};
+        if (c == '\'' || c == '"') {
+            size_t fim = expressao.find(c, i + 1);
+            if (fim == string::npos) {
+                cerr << "Aspas sem fechamento na expressão." << endl;
+                return false;
+            }
+            termo.texto = expressao.substr(i + 1, fim - i - 1);
+            termo.literal = true;
+            i = fim + 1;
+        } else if (strchr("=!<>", c)) {
+            termo.texto = c;
+            if (i + 1 < expressao.size() && expressao[i + 1] == '=') {
+                termo.texto += '=';
+            }
+            i += termo.texto.size();
+        } else {
+            size_t fim = i;
+            while (fim < expressao.size() && !isspace(static_cast<unsigned char>(expressao[fim])) &&
+                   !strchr("=!<>'\"", expressao[fim])) {
+                ++fim;
+            }
+            termo.texto = expressao.substr(i, fim - i);
+            i = fim;
+        }
     }
+    return true;
+}
 
-    base.dados[indice] = atualizado;
-    if (!salvar_clientes(base)) {
+bool palavra_chave(const TermoConsulta *termos, size_t total, size_t posicao, const char *palavra) {
+    if (posicao >= total || termos[posicao].literal) {
+        return false;
+    }
+    const string &texto = termos[posicao].texto;
+    if (texto.size() != strlen(palavra)) {
+        return false;
+    }
+    for (size_t i = 0; i < texto.size(); ++i) {
+        if (tolower(static_cast<unsigned char>(texto[i])) != palavra[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Converte o valor conforme o tipo do campo; de um texto fica só o nível
+// primário da chave de colação, comparado com o dos registros
+bool interpretar_valor_consulta(PredicadoConsulta &p, size_t k, const string &valor) {
+    if (!interpretar_valor_campo(p.campo, valor, p.numero[k], p.texto[k])) {
         return false;
     }
+    if (ESQUEMA_CLIENTE[p.campo].tipo == TipoCampo::Texto) {
+        ChaveColacao chave;
+        gerar_chave_colacao(valor.c_str(), chave);
+        p.texto[k] = chave.completa.substr(0, chave.completa.find('\x01'));
+    }
+    return true;
+}
 
-    base.solicitar_salvar = true;
-    cout << endl << "Registro atualizado com sucesso!" << endl << endl;
+// predicado (and predicado)* [order by campo [asc|desc]] [limit N]
+// predicado: campo (= | != | < | <= | > | >=) valor | campo between v1 and v2
+bool interpretar_consulta(const string &expressao, Consulta &consulta) {
+    TermoConsulta termos[MAX_TERMOS];
+    size_t total = 0;
+    if (!separar_termos(expressao, termos, total)) {
+        return false;
+    }
+
+    size_t i = 0;
+    while (i < total && !palavra_chave(termos, total, i, "order") && !palavra_chave(termos, total, i, "limit")) {
+        if (consulta.total_predicados > 0 && !palavra_chave(termos, total, i++, "and")) {
+            cerr << "Esperado 'and' antes de '" << termos[i - 1].texto << "'." << endl;
+            return false;
+        }
+        if (i >= total || consulta.total_predicados == MAX_PREDICADOS) {
+            cerr << "Predicado incompleto ou predicados demais." << endl;
+            return false;
+        }
+        const int campo = procurar_campo_consulta(termos[i].texto);
+        if (campo < 0) {
+            cerr << "Campo desconhecido: '" << termos[i].texto << "'." << endl;
+            return false;
+        }
+        PredicadoConsulta &p = consulta.predicados[consulta.total_predicados];
+        p = PredicadoConsulta{};
+        p.campo = static_cast<size_t>(campo);
+        bool valido = false;
+        if (palavra_chave(termos, total, i + 1, "between")) {
+            p.operador = OperadorConsulta::Entre;
+            valido = i + 4 < total && palavra_chave(termos, total, i + 3, "and") &&
+                     interpretar_valor_consulta(p, 0, termos[i + 2].texto) &&
+                     interpretar_valor_consulta(p, 1, termos[i + 4].texto);
+            i += 5;
+        } else if (i + 2 < total && !termos[i + 1].literal) {
+            const string &operador = termos[i + 1].texto;
+            valido = true;
+            if (operador == "=") {
+                p.operador = OperadorConsulta::Igual;
+            } else if (operador == "!=") {
+                p.operador = OperadorConsulta::Diferente;
+            } else if (operador == "<") {
+                p.operador = OperadorConsulta::Menor;
+            } else if (operador == "<=") {
+                p.operador = OperadorConsulta::MenorIgual;
+            } else if (operador == ">") {
+                p.operador = OperadorConsulta::Maior;
+            } else if (operador == ">=") {
+                p.operador = OperadorConsulta::MaiorIgual;
+            } else {
+                valido = false;
+            }
+            valido = valido && interpretar_valor_consulta(p, 0, termos[i + 2].texto);
+            i += 3;
+        }
+        if (!valido) {
+            cerr << "Predicado inválido para o campo '" << ESQUEMA_CLIENTE[campo].nome << "'." << endl;
+            return false;
+        }
+        consulta.total_predicados++;
+    }
+
+    if (palavra_chave(termos, total, i, "order")) {
+        const int campo = palavra_chave(termos, total, i + 1, "by") && i + 2 < total
+                              ? procurar_campo_consulta(termos[i + 2].texto)
+                              : -1;
+        if (campo < 0) {
+            cerr << "Use 'order by campo [asc|desc]'." << endl;
+            return false;
+        }
+        consulta.campo_ordem = campo;
+        i += 3;
+        if (palavra_chave(termos, total, i, "asc") || palavra_chave(termos, total, i, "desc")) {
+            consulta.decrescente = palavra_chave(termos, total, i, "desc");
+            ++i;
+        }
+    }
+    if (palavra_chave(termos, total, i, "limit")) {
+        const string valor = i + 1 < total ? termos[i + 1].texto : "";
+        const from_chars_result resultado = from_chars(valor.data(), valor.data() + valor.size(), consulta.limite);
+        if (valor.empty() || resultado.ec != errc() || resultado.ptr != valor.data() + valor.size() ||
+            consulta.limite == 0) {
+            cerr << "Use 'limit N', com N positivo." << endl;
+            return false;
+        }
+        i += 2;
+    }
+    if (i < total) {
+        cerr << "Termo inesperado: '" << termos[i].texto << "'." << endl;
+        return false;
+    }
     return true;
 }
 
-bool remover_cliente(BaseClientes &base) {
-    desenhar_banner("Remover cliente");
-    int id = ler_inteiro("Informe o ID para exclusão");
-    int indice = encontrar_indice_por_id(base, id);
-    if (indice < 0) {
-        cout << endl << "Cliente não encontrado." << endl << endl;
+// Faixa [minimo, maximo] implicada pelos predicados numéricos do campo
+void restringir_faixa(const Consulta &consulta, size_t campo, double passo, double &minimo, double &maximo) {
+    for (size_t i = 0; i < consulta.total_predicados; ++i) {
+        const PredicadoConsulta &p = consulta.predicados[i];
+        if (p.campo != campo) {
+            continue;
+        }
+        double baixo = -numeric_limits<double>::infinity();
+        double alto = numeric_limits<double>::infinity();
+        switch (p.operador) {
+            case OperadorConsulta::Igual: baixo = alto = p.numero[0]; break;
+            case OperadorConsulta::Menor: alto = p.numero[0] - passo; break;
+            case OperadorConsulta::MenorIgual: alto = p.numero[0]; break;
+            case OperadorConsulta::Maior: baixo = p.numero[0] + passo; break;
+            case OperadorConsulta::MaiorIgual: baixo = p.numero[0]; break;
+            case OperadorConsulta::Entre: baixo = p.numero[0]; alto = p.numero[1]; break;
+            case OperadorConsulta::Diferente: break;
+        }
+        minimo = baixo > minimo ? baixo : minimo;
+        maximo = alto < maximo ? alto : maximo;
+    }
+}
+
+char valor_categorico(const Consulta &consulta, size_t campo) {
+    for (size_t i = 0; i < consulta.total_predicados; ++i) {
+        const PredicadoConsulta &p = consulta.predicados[i];
+        if (p.campo == campo && p.operador == OperadorConsulta::Igual) {
+            return p.texto[0][0];
+        }
+    }
+    return '\0';
+}
+
+// Escolhe o caminho mais barato. A varredura paralela custa n dividido
+// pelos trabalhadores; a faixa de ID (busca binária nos extremos) custa os
+// registros da faixa; o ranking custa os candidatos do segmento
+// (situação/tipo) na faixa de limite, cada um com uma busca pelo ID.
+void planejar_consulta(BaseClientes &base, const Consulta &consulta, PlanoConsulta &plano) {
+    constexpr size_t CAMPO_ID = 0;
+    constexpr size_t CAMPO_TIPO = 5;
+    constexpr size_t CAMPO_LIMITE = 8;
+    constexpr size_t CAMPO_SITUACAO = 9;
+    static_assert(ESQUEMA_CLIENTE[CAMPO_ID].deslocamento == offsetof(Cliente, id) &&
+                      ESQUEMA_CLIENTE[CAMPO_TIPO].deslocamento == offsetof(Cliente, tipo_cliente) &&
+                      ESQUEMA_CLIENTE[CAMPO_LIMITE].deslocamento == offsetof(Cliente, limite_credito) &&
+                      ESQUEMA_CLIENTE[CAMPO_SITUACAO].deslocamento == offsetof(Cliente, situacao_cadastral),
+                  "posições dos campos usados pelo planejador");
+
+    plano = PlanoConsulta{};
+    const size_t blocos = (base.tamanho + REGISTROS_POR_BLOCO - 1) / REGISTROS_POR_BLOCO;
+    plano.custo = static_cast<double>(base.tamanho) / static_cast<double>(quantidade_de_trabalhadores(blocos));
+
+    double id_minimo = -numeric_limits<double>::infinity();
+    double id_maximo = numeric_limits<double>::infinity();
+    restringir_faixa(consulta, CAMPO_ID, 1.0, id_minimo, id_maximo);
+    if (id_minimo > 0 || id_maximo < numeric_limits<int>::max()) { // a base está em ordem de ID
+        size_t inicio = 0;
+        size_t fim = base.tamanho;
+        while (inicio < fim) { // primeiro ID >= id_minimo
+            size_t meio = inicio + (fim - inicio) / 2;
+            if (base.dados[meio].id < id_minimo) {
+                inicio = meio + 1;
+            } else {
+                fim = meio;
+            }
+        }
+        const size_t primeiro = inicio;
+        fim = base.tamanho;
+        while (inicio < fim) { // primeiro ID > id_maximo
+            size_t meio = inicio + (fim - inicio) / 2;
+            if (base.dados[meio].id <= id_maximo) {
+                inicio = meio + 1;
+            } else {
+                fim = meio;
+            }
+        }
+        if (static_cast<double>(inicio - primeiro) < plano.custo) {
+            plano.caminho = CaminhoAcesso::FaixaDeId;
+            plano.custo = static_cast<double>(inicio - primeiro);
+            plano.inicio = primeiro;
+            plano.fim = inicio;
+        }
+    }
+
+    // o ranking só responde se estiver completo (a linha de comando o
+    // constrói; cargas com índices suspensos não)
+    if (tamanho_no(base.ranking[SEGMENTO_TODOS], base.ranking[SEGMENTO_TODOS].raiz) != base.resumo.total) {
+        return;
+    }
+    double limite_minimo = -numeric_limits<double>::infinity();
+    double limite_maximo = numeric_limits<double>::infinity();
+    restringir_faixa(consulta, CAMPO_LIMITE, 0.0, limite_minimo, limite_maximo);
+    const bool ativos = valor_categorico(consulta, CAMPO_SITUACAO) == 'A';
+    const char tipo = valor_categorico(consulta, CAMPO_TIPO);
+    size_t segmento = ativos ? SEGMENTO_ATIVOS : SEGMENTO_TODOS;
+    if (tipo == 'F') {
+        segmento = ativos ? SEGMENTO_ATIVOS_FISICA : SEGMENTO_FISICA;
+    } else if (tipo == 'J') {
+        segmento = ativos ? SEGMENTO_ATIVOS_JURIDICA : SEGMENTO_JURIDICA;
+    }
+    const ArvoreRanking &arvore = base.ranking[segmento];
+    const float minimo = limite_minimo < -numeric_limits<float>::max()
+                             ? -numeric_limits<float>::max()
+                             : static_cast<float>(limite_minimo - 0.005);
+    const float maximo = limite_maximo > numeric_limits<float>::max() ? numeric_limits<float>::max()
+                                                                       : static_cast<float>(limite_maximo + 0.005);
+    const size_t inicio = contar_menores(arvore, minimo, numeric_limits<int>::min());
+    const size_t ate_o_maximo = contar_menores(arvore, maximo, numeric_limits<int>::max());
+    const size_t candidatos = ate_o_maximo > inicio ? ate_o_maximo - inicio : 0;
+
+    // com 'order by limite', o percurso já sai na ordem pedida e o limite
+    // encerra a busca cedo; o custo é estimado pela fração lida
+    const bool ja_ordenado = consulta.campo_ordem == static_cast<int>(CAMPO_LIMITE);
+    double lidos = static_cast<double>(candidatos);
+    if (ja_ordenado && consulta.limite > 0 && consulta.limite < candidatos) {
+        lidos = static_cast<double>(consulta.limite);
+    }
+    const double custo = lidos * CUSTO_ACESSO_ALEATORIO;
+    if (custo < plano.custo) {
+        plano.caminho = CaminhoAcesso::Ranking;
+        plano.custo = custo;
+        plano.segmento = segmento;
+        plano.limite_minimo = minimo;
+        plano.limite_maximo = maximo;
+        plano.candidatos = candidatos;
+        plano.posicao_inicial = consulta.decrescente && ja_ordenado ? tamanho_no(arvore, arvore.raiz) - ate_o_maximo
+                                                                    : inicio;
+        plano.ja_ordenado = ja_ordenado;
+    }
+}
+
+string descrever_plano(const BaseClientes &base, const PlanoConsulta &plano) {
+    ostringstream descricao;
+    switch (plano.caminho) {
+        case CaminhoAcesso::FaixaDeId:
+            descricao << "busca binária na ordem de ID (" << plano.fim - plano.inicio << " registro(s) na faixa)";
+            break;
+        case CaminhoAcesso::Ranking:
+            descricao << "ranking do segmento '" << NOMES_SEGMENTOS[plano.segmento] << "' (" << plano.candidatos
+                      << " candidato(s) na faixa de limite)";
+            break;
+        case CaminhoAcesso::VarreduraParalela: {
+            const size_t blocos = (base.tamanho + REGISTROS_POR_BLOCO - 1) / REGISTROS_POR_BLOCO;
+            descricao << "varredura paralela (" << base.tamanho << " registro(s), "
+                      << quantidade_de_trabalhadores(blocos) << " thread(s))";
+            break;
+        }
+    }
+    return descricao.str();
+}
+
+// Percorre o ranking em lotes, confirmando cada candidato no registro
+bool executar_pelo_ranking(BaseClientes &base, const Consulta &consulta, const PlanoConsulta &plano,
+                           SelecaoConsulta &selecao) {
+    ChaveRanking *lote = new (nothrow) ChaveRanking[LOTE_RANKING];
+    if (!lote) {
+        perror("Falha ao alocar memória para a consulta");
+        return false;
+    }
+    const bool decrescente = plano.ja_ordenado && consulta.decrescente;
+    bool ok = true;
+    size_t posicao = plano.posicao_inicial;
+    size_t lidos = LOTE_RANKING;
+    while (ok && lidos == LOTE_RANKING &&
+           !(plano.ja_ordenado && consulta.limite > 0 && selecao.quantidade >= consulta.limite)) {
+        lidos = percorrer_ranking(base.ranking[plano.segmento], posicao, decrescente, plano.limite_minimo,
+                                  plano.limite_maximo, lote, LOTE_RANKING);
+        posicao += lidos;
+        for (size_t i = 0; ok && i < lidos; ++i) {
+            int indice = busca_binaria_id(base.dados, base.tamanho, lote[i].id);
+            if (indice >= 0 && atende_consulta(base.dados[indice], consulta)) {
+                ok = anexar_posicao(selecao, static_cast<size_t>(indice));
+            }
+        }
+    }
+    delete[] lote;
+    return ok;
+}
+
+// Cada bloco guarda as suas posições; a junção preserva a ordem da base
+bool executar_varredura(BaseClientes &base, const Consulta &consulta, SelecaoConsulta &selecao) {
+    const size_t blocos = (base.tamanho + REGISTROS_POR_BLOCO - 1) / REGISTROS_POR_BLOCO;
+    SelecaoConsulta *parciais = new (nothrow) SelecaoConsulta[blocos + 1];
+    if (!parciais) {
+        perror("Falha ao alocar memória para a consulta");
         return false;
     }
-
-    return escolher_remocao(base, static_cast<size_t>(indice));
+    atomic<bool> falhou{false};
+    executar_em_paralelo(blocos, [&](size_t b) {
+        const size_t fim = (b + 1) * REGISTROS_POR_BLOCO < base.tamanho ? (b + 1) * REGISTROS_POR_BLOCO : base.tamanho;
+        for (size_t i = b * REGISTROS_POR_BLOCO; i < fim; ++i) {
+            if (atende_consulta(base.dados[i], consulta) && !anexar_posicao(parciais[b], i)) {
+                falhou = true;
+                return;
+            }
+        }
+    });
+    bool ok = !falhou;
+    for (size_t b = 0; b < blocos; ++b) {
+        for (size_t i = 0; ok && i < parciais[b].quantidade; ++i) {
+            ok = anexar_posicao(selecao, parciais[b].posicoes[i]);
+        }
+        liberar_selecao(parciais[b]);
+    }
+    delete[] parciais;
+    return ok;
 }
 
-bool editar_por_indice(BaseClientes &base, size_t indice) {
-    int id = base.dados[indice].id;
-    cout << endl << "Editando registro de " << base.dados[indice].nome_completo << " (ID " << id << ")" << endl;
-    Cliente atualizado = ler_dados_cliente(id);
+struct PosicaoPorNome {
+    ChaveColacao chave;
+    size_t posicao;
+};
 
-    for (size_t i = 0; i < base.tamanho; ++i) {
-        bool mesmo_indice = i == indice;
-        if (!mesmo_indice && strcmp(base.dados[i].documento, atualizado.documento) == 0) {
-            cout << endl << "Documento " << atualizado.documento << " já cadastrado em outro cliente." << endl << endl;
+// Ordena as posições pelo campo pedido (nomes pela colação da base),
+// de forma estável; a ordem de ID desempata. Em ordem decrescente o
+// empate também se inverte (maior ID primeiro), como no percurso do
+// ranking por (limite, ID), para que o resultado não dependa do plano.
+bool ordenar_selecao(BaseClientes &base, const Consulta &consulta, SelecaoConsulta &selecao) {
+    if (consulta.campo_ordem < 0) {
+        return true;
+    }
+    if (consulta.decrescente) {
+        // as posições chegam em ordem de ID; invertidas, a ordenação
+        // estável mantém os empates do maior para o menor ID
+        for (size_t i = 0, j = selecao.quantidade; i + 1 < j; ++i, --j) {
+            swap(selecao.posicoes[i], selecao.posicoes[j - 1]);
+        }
+    }
+    const size_t campo = static_cast<size_t>(consulta.campo_ordem);
+    bool ok = true;
+    if (ESQUEMA_CLIENTE[campo].deslocamento == offsetof(Cliente, nome_completo)) {
+        PosicaoPorNome *entradas = new (nothrow) PosicaoPorNome[selecao.quantidade + 1];
+        if (!entradas) {
+            perror("Falha ao alocar memória para a ordenação");
             return false;
         }
+        for (size_t i = 0; i < selecao.quantidade; ++i) {
+            entradas[i].chave = chave_do_registro(base.dados[selecao.posicoes[i]]);
+            entradas[i].posicao = selecao.posicoes[i];
+        }
+        ok = ordenar_intercalando(entradas, selecao.quantidade, [&](const PosicaoPorNome &a, const PosicaoPorNome &b) {
+            return consulta.decrescente ? chave_colacao_menor(b.chave, a.chave) : chave_colacao_menor(a.chave, b.chave);
+        });
+        for (size_t i = 0; ok && i < selecao.quantidade; ++i) {
+            selecao.posicoes[i] = entradas[i].posicao;
+        }
+        delete[] entradas;
+    } else {
+        const ComparadorCampo menor = OperacoesConsulta::menor[campo];
+        const Cliente *dados = base.dados;
+        ok = ordenar_intercalando(selecao.posicoes, selecao.quantidade, [&](size_t a, size_t b) {
+            return consulta.decrescente ? menor(dados[b], dados[a]) : menor(dados[a], dados[b]);
+        });
+    }
+    if (!ok) {
+        perror("Falha ao alocar memória para a ordenação");
     }
+    return ok;
+}
 
-    base.dados[indice] = atualizado;
-    if (!salvar_clientes(base)) {
-        return false;
+// Planeja, executa, ordena e aplica o limite. A base fica em ordem de ID
+// durante a consulta para que as posições e a busca binária valham.
+bool executar_consulta(BaseClientes &base, const Consulta &consulta, PlanoConsulta &plano, SelecaoConsulta &selecao) {
+    ordenar_por_id(base.dados, base.tamanho);
+    planejar_consulta(base, consulta, plano);
+    bool ok = true;
+    switch (plano.caminho) {
+        case CaminhoAcesso::FaixaDeId:
+            for (size_t i = plano.inicio; ok && i < plano.fim; ++i) {
+                if (atende_consulta(base.dados[i], consulta)) {
+                    ok = anexar_posicao(selecao, i);
+                }
+            }
+            break;
+        case CaminhoAcesso::Ranking:
+            ok = executar_pelo_ranking(base, consulta, plano, selecao);
+            if (ok && !plano.ja_ordenado) {
+                ok = ordenar_intercalando(selecao.posicoes, selecao.quantidade, [](size_t a, size_t b) { return a < b; });
+            }
+            break;
+        case CaminhoAcesso::VarreduraParalela:
+            ok = executar_varredura(base, consulta, selecao);
+            break;
+    }
+    if (ok && !plano.ja_ordenado) {
+        ok = ordenar_selecao(base, consulta, selecao);
+    }
+    if (ok && consulta.limite > 0 && selecao.quantidade > consulta.limite) {
+        selecao.quantidade = consulta.limite;
     }
+    return ok;
+}
 
-    base.solicitar_salvar = true;
-    cout << endl << "Registro atualizado com sucesso!" << endl << endl;
-    return true;
+// Mostra os resultados em páginas de cartões, uma escrita por página
+void exibir_resultados_consulta(const BaseClientes &base, const SelecaoConsulta &selecao, const string &plano,
+                                double segundos) {
+    size_t indice = 0;
+    do {
+        const size_t ate = indice + RESULTADOS_POR_PAGINA < selecao.quantidade ? indice + RESULTADOS_POR_PAGINA
+                                                                               : selecao.quantidade;
+        ostringstream tela;
+        desenhar_banner(tela, "Resultado da consulta");
+        tela << "Plano: " << plano << "\n";
+        tela << selecao.quantidade << " cliente(s) em " << fixed << setprecision(3) << segundos << " s";
+        if (selecao.quantidade > 0) {
+            tela << ", mostrando " << (indice + 1) << " a " << ate;
+        }
+        tela << "\n\n";
+        for (size_t i = indice; i < ate; ++i) {
+            imprimir_cartao(tela, base.dados[selecao.posicoes[i]]);
+        }
+        escrever_tela(tela.str());
+        indice = ate;
+        if (indice >= selecao.quantidade) {
+            return;
+        }
+        string opcao = ler_linha("[P]róxima página, [S]air");
+        if (opcao.empty() || toupper(static_cast<unsigned char>(opcao[0])) != 'P') {
+            return;
+        }
+    } while (true);
 }
 
-bool remover_por_indice(BaseClientes &base, size_t indice) {
-    cout << endl << "Removendo registro de ID " << base.dados[indice].id << "..." << endl;
-    for (size_t i = indice; i + 1 < base.tamanho; ++i) {
-        base.dados[i] = base.dados[i + 1];
+void consultar_interativo(BaseClientes &base) {
+    desenhar_banner("Consulta por expressão");
+    cout << "Campos: id, nome, endereco, ano, documento, tipo, sexo, estado_civil, limite, situacao" << endl
+         << "Operadores: = != < <= > >= e 'campo between A and B', unidos por 'and'" << endl
+         << "Opcional: order by campo [asc|desc] limit N" << endl
+         << "Exemplo: situacao=A and tipo=J and limite>=20000 and ano between 1950 and 1970" << endl
+         << endl;
+    const string expressao = ler_linha("Expressão (ENTER para todos)");
+    Consulta consulta;
+    if (!interpretar_consulta(expressao, consulta)) {
+        return;
     }
-    --base.tamanho;
-    if (!salvar_clientes(base)) {
-        return false;
+    PlanoConsulta plano;
+    SelecaoConsulta selecao;
+    auto inicio = chrono::steady_clock::now();
+    if (executar_consulta(base, consulta, plano, selecao)) {
+        chrono::duration<double> decorrido = chrono::steady_clock::now() - inicio;
+        exibir_resultados_consulta(base, selecao, descrever_plano(base, plano), decorrido.count());
     }
-    base.solicitar_salvar = true;
-    cout << endl << "Cliente removido com sucesso!" << endl << endl;
-    return true;
+    liberar_selecao(selecao);
 }
 
-bool remover_logicamente(BaseClientes &base, size_t indice) {
-    cout << endl << "Marcando registro de ID " << base.dados[indice].id << " como removido..." << endl;
-    base.dados[indice].id = -abs(base.dados[indice].id);
-    base.dados[indice].situacao_cadastral = 'I';
-    base.solicitar_salvar = true;
-    cout << endl << "Registro marcado para remoção. Ele será eliminado fisicamente na próxima gravação." << endl << endl;
-    return true;
+// --------------------------------------------------------------
+// Interface
+// --------------------------------------------------------------
+
+void pausar() {
+    cout << "Pressione ENTER para continuar...";
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
 }
 
-bool escolher_remocao(BaseClientes &base, size_t indice) {
-    for (;;) {
-        string opcao = ler_linha("Remover [L]ogicamente, remover [F]isicamente, [V]oltar: ");
-        if (opcao.empty()) {
-            return false;
-        }
-        char acao = static_cast<char>(toupper(static_cast<unsigned char>(opcao[0])));
-        switch (acao) {
-            case 'L':
-                return remover_logicamente(base, indice);
-            case 'F':
-                return remover_por_indice(base, indice);
-            case 'V':
-                return false;
-            default:
-                cout << "Opção inválida. Tente novamente." << endl;
+bool saida_e_terminal() {
+    #ifdef _WIN32
+    static const bool terminal = _isatty(_fileno(stdout)) != 0;
+    #else
+    static const bool terminal = isatty(STDOUT_FILENO) != 0;
+    #endif
+    return terminal;
+}
+
+// Envia a tela já montada ao terminal com uma única chamada de escrita,
+// descarregando antes o que ainda estiver pendente em cout
+void escrever_tela(const string &conteudo) {
+    cout.flush();
+    #ifdef _WIN32
+    fwrite(conteudo.data(), 1, conteudo.size(), stdout);
+    fflush(stdout);
+    #else
+    const char *ponteiro = conteudo.data();
+    size_t restante = conteudo.size();
+    while (restante > 0) {
+        ssize_t escrito = write(STDOUT_FILENO, ponteiro, restante);
+        if (escrito < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Falha ao escrever na tela");
+            return;
         }
+        ponteiro += escrito;
+        restante -= static_cast<size_t>(escrito);
     }
+    #endif
 }
 
-bool manipular_cliente(BaseClientes &base, size_t indice) {
-    for (;;) {
-        string opcao = ler_linha("[E]ditar, [R]emover, [N]ovo cadastro, [V]oltar: ");
-        if (opcao.empty()) {
-            return false;
-        }
-        char acao = static_cast<char>(toupper(static_cast<unsigned char>(opcao[0])));
-        switch (acao) {
-            case 'E':
-                return editar_por_indice(base, indice);
-            case 'R':
-                return escolher_remocao(base, indice);
-            case 'N':
-                return inserir_cliente(base);
-            case 'V':
-                return false;
-            default:
-                cout << "Opção inválida. Tente novamente." << endl;
-        }
+#ifdef _WIN32
+// O console do Windows só interpreta sequências ANSI com o modo VT ativo;
+// consoles antigos recusam o modo e continuam usando "cls"
+bool habilitar_sequencias_ansi() {
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD modo = 0;
+    if (console == INVALID_HANDLE_VALUE || !GetConsoleMode(console, &modo)) {
+        return false;
     }
+    return (modo & ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0 ||
+           SetConsoleMode(console, modo | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
 }
+#endif
 
-void buscar_por_id(BaseClientes &base) {
-    desenhar_banner("Busca por ID");
-    int id = ler_inteiro("Informe o ID para busca");
-    int indice = encontrar_indice_por_id(base, id);
-    if (indice < 0) {
-        cout << endl << "Nenhum cliente com ID " << id << " encontrado." << endl << endl;
+// Limpa a tela com sequências ANSI (cursor no topo, apaga tela e histórico);
+// fora de um terminal (redirecionamento, pipe) nada é emitido
+void limpar_tela(ostream &saida) {
+    if (!saida_e_terminal()) {
+        return;
+    }
+    #ifdef _WIN32
+    static const bool ansi = habilitar_sequencias_ansi();
+    if (!ansi) {
+        cout.flush();
+        system("cls");
         return;
     }
+    #endif
+    saida << "\x1b[H\x1b[2J\x1b[3J";
+}
 
-    const Cliente &c = base.dados[indice];
-    imprimir_cartao(c);
-    manipular_cliente(base, static_cast<size_t>(indice));
+void desenhar_banner(ostream &saida, const string &titulo) {
+    limpar_tela(saida);
+    saida << "==================================================\n";
+    saida << "  " << titulo << "\n";
+    saida << "==================================================\n\n";
 }
 
-void buscar_por_nome(BaseClientes &base) {
-    desenhar_banner("Busca por nome");
-    string termo = ler_linha("Digite o nome completo para busca exata");
+void desenhar_banner(const string &titulo) {
+    ostringstream tela;
+    desenhar_banner(tela, titulo);
+    escrever_tela(tela.str());
+}
 
-    // cria uma cópia para ordenar por nome sem perder a ordem de gravação
-    Cliente *copia = new (nothrow) Cliente[base.tamanho];
-    if (!copia) {
-        perror("Falha ao alocar memória");
-        return;
-    }
+void exibir_menu(const BaseClientes &base) {
+    ostringstream tela;
+    desenhar_banner(tela, "Sistema de Gerenciamento de Clientes");
+    tela << base.resumo.total << " cliente(s): " << base.resumo.por_situacao[0] << " ativo(s), "
+         << base.resumo.por_situacao[1] << " inativo(s)\n\n";
+    tela << "1 - Listar clientes\n";
+    tela << "2 - Inserir novo cliente\n";
+    tela << "3 - Atualizar cliente\n";
+    tela << "4 - Remover cliente\n";
+    tela << "5 - Buscar por ID (binária)\n";
+    tela << "6 - Buscar por nome (binária)\n";
+    tela << "7 - Mostrar trecho armazenado\n";
+    tela << "8 - Ordenar e salvar\n";
+    tela << "9 - Busca aproximada (nome/endereço)\n";
+    tela << "10 - Mesclar CSV externo\n";
+    tela << "11 - Exportar para análise (JSON Lines/binário colunar)\n";
+    tela << "12 - Ranking de limite de crédito\n";
+    tela << "13 - Exportar CSV completo agora\n";
+    tela << "14 - Painel de indicadores\n";
+    tela << "15 - Consulta por expressão\n";
+    tela << "0 - Sair\n";
+    escrever_tela(tela.str());
+}
 
-    for (size_t i = 0; i < base.tamanho; ++i) {
-        copia[i] = base.dados[i];
+// --------------------------------------------------------------
+// Linha de comando
+// --------------------------------------------------------------
+
+void exibir_uso(const char *programa) {
+    cerr << "Uso:" << endl
+         << "  " << programa << "                      (modo interativo)" << endl
+         << "  " << programa << " merge <arquivo.csv>  (mescla CSV externo na base)" << endl
+         << "  " << programa << " export --format jsonl|bin [--cols c1,c2,...] [--where campo=valor]... --out <arquivo>" << endl
+         << "  " << programa << " csv                  (regrava o clientes.csv completo)" << endl
+         << "  " << programa << " query \"<expressão>\" [--format csv|json]  (filtra, ordena e limita; veja a opção 15)" << endl
+         << "  " << programa << " get --id N | --doc X [--format csv|json]  (consulta um cliente sem carregar a base)" << endl
+         << "  " << programa << " --verify             (verifica a integridade dos arquivos de dados)" << endl
+         << "  " << programa << " --repair             (verifica e regrava a base sem os registros inválidos)" << endl;
+}
+
+int comando_merge(int argc, char *argv[]) {
+    if (argc != 3) {
+        exibir_uso(argv[0]);
+        return 2;
+    }
+    BaseClientes base;
+    if (!carregar_clientes(base)) {
+        return 1;
     }
+    ResumoMesclagem resumo;
+    auto inicio = chrono::steady_clock::now();
+    bool ok = mesclar_csv(base, argv[2], resumo);
+    chrono::duration<double> decorrido = chrono::steady_clock::now() - inicio;
+    exibir_resumo_mesclagem(resumo, decorrido.count());
+    destruir_base(base);
+    return ok ? 0 : 1;
+}
 
-    int indice = busca_binaria_nome(copia, base.tamanho, termo);
-    if (indice < 0) {
-        cout << endl << "Nenhum cliente chamado '" << termo << "' encontrado." << endl << endl;
-    } else {
-        const Cliente &c = copia[indice];
-        imprimir_cartao(c);
-        int real = encontrar_indice_por_id(base, c.id);
-        if (real >= 0) {
-            manipular_cliente(base, static_cast<size_t>(real));
+int comando_export(int argc, char *argv[]) {
+    OpcoesExportacao opcoes;
+    bool formato_definido = false;
+    definir_colunas(opcoes, "");
+    for (int i = 2; i < argc; ++i) {
+        const string argumento = argv[i];
+        if (i + 1 >= argc) {
+            exibir_uso(argv[0]);
+            return 2;
+        }
+        const string valor = argv[++i];
+        if (argumento == "--format" && (valor == "jsonl" || valor == "bin")) {
+            opcoes.formato = valor == "bin" ? FormatoExportacao::BinarioColunar : FormatoExportacao::JsonLines;
+            formato_definido = true;
+        } else if (argumento == "--cols") {
+            if (!definir_colunas(opcoes, valor)) {
+                return 2;
+            }
+        } else if (argumento == "--where") {
+            if (!adicionar_filtro(opcoes, valor)) {
+                return 2;
+            }
+        } else if (argumento == "--out") {
+            opcoes.destino = valor;
+        } else {
+            exibir_uso(argv[0]);
+            return 2;
         }
     }
+    if (!formato_definido || opcoes.destino.empty()) {
+        exibir_uso(argv[0]);
+        return 2;
+    }
 
-    delete[] copia;
+    BaseClientes base;
+    base.indices_suspensos = true; // a exportação não usa o índice de trigramas
+    if (!carregar_clientes(base)) {
+        return 1;
+    }
+    size_t exportados = 0;
+    bool ok = exportar_base(base, opcoes, exportados);
+    if (ok) {
+        cout << exportados << " registro(s) exportado(s) para " << opcoes.destino << endl;
+    }
+    destruir_base(base);
+    return ok ? 0 : 1;
 }
 
-void submenu_ordenacao(BaseClientes &base) {
-    bool sair = false;
-    while (!sair) {
-        desenhar_banner("Ordenar e salvar base");
-        cout << "1 - Ordenar por ID e salvar" << endl;
-        cout << "2 - Ordenar por nome e salvar" << endl;
-        cout << "0 - Voltar" << endl;
+int comando_csv(int argc, char *argv[]) {
+    if (argc != 2) {
+        exibir_uso(argv[0]);
+        return 2;
+    }
+    BaseClientes base;
+    base.indices_suspensos = true;
+    if (!carregar_clientes(base)) {
+        return 1;
+    }
+    bool ok = exportar_csv_completo(base);
+    destruir_base(base);
+    return ok ? 0 : 1;
+}
 
-        int opcao = ler_inteiro("Escolha uma opção");
-        switch (opcao) {
-            case 1:
-                if (salvar_clientes(base, false)) {
-                    base.solicitar_salvar = false;
-                    cout << endl << "Base ordenada por ID e salva." << endl << endl;
-                }
-                pausar();
-                break;
-            case 2:
-                if (salvar_clientes(base, true)) {
-                    base.solicitar_salvar = false;
-                    cout << endl << "Base ordenada por nome e salva." << endl << endl;
-                }
-                pausar();
-                break;
-            case 0:
-                sair = true;
-                break;
-            default:
-                cout << "Opção inválida." << endl;
-                pausar();
-                break;
+// Executa uma consulta por expressão e escreve o resultado em CSV ou
+// JSON Lines; o plano escolhido vai para a saída de erro
+int comando_query(int argc, char *argv[]) {
+    bool json = false;
+    if (argc == 5 && string(argv[3]) == "--format" && (string(argv[4]) == "csv" || string(argv[4]) == "json")) {
+        json = string(argv[4]) == "json";
+    } else if (argc != 3) {
+        exibir_uso(argv[0]);
+        return 2;
+    }
+    Consulta consulta;
+    if (!interpretar_consulta(argv[2], consulta)) {
+        return 2;
+    }
+
+    BaseClientes base;
+    base.indices_suspensos = true; // só o ranking é usado pelo planejador
+    if (!carregar_clientes(base)) {
+        return 1;
+    }
+    reconstruir_rankings(base);
+    PlanoConsulta plano;
+    SelecaoConsulta selecao;
+    auto inicio = chrono::steady_clock::now();
+    bool ok = executar_consulta(base, consulta, plano, selecao);
+    chrono::duration<double> decorrido = chrono::steady_clock::now() - inicio;
+    if (ok) {
+        string saida = json ? "" : CABECALHO_CSV;
+        for (size_t i = 0; i < selecao.quantidade; ++i) {
+            formatar_registro(saida, base.dados[selecao.posicoes[i]], json);
         }
+        cout << saida;
+        cerr << "Plano: " << descrever_plano(base, plano) << "; " << selecao.quantidade << " cliente(s) em "
+             << fixed << setprecision(3) << decorrido.count() << " s" << endl;
     }
+    liberar_selecao(selecao);
+    destruir_base(base);
+    return ok ? 0 : 1;
 }
 
-// --------------------------------------------------------------
-// Interface
-// --------------------------------------------------------------
+// Consulta um cliente direto dos arquivos de dados. Retorna 0 quando o
+// encontra, 1 quando não existe e 2 em erro de uso ou de leitura.
+int comando_get(int argc, char *argv[]) {
+    int id = 0;
+    string documento;
+    bool json = false;
+    bool chave_definida = false;
+    for (int i = 2; i < argc; ++i) {
+        const string argumento = argv[i];
+        if (i + 1 >= argc) {
+            exibir_uso(argv[0]);
+            return 2;
+        }
+        const string valor = argv[++i];
+        if (argumento == "--id" && !chave_definida) {
+            const from_chars_result resultado = from_chars(valor.data(), valor.data() + valor.size(), id);
+            if (resultado.ec != errc() || resultado.ptr != valor.data() + valor.size() || id <= 0) {
+                cerr << "ID inválido: '" << valor << "'" << endl;
+                return 2;
+            }
+            chave_definida = true;
+        } else if (argumento == "--doc" && !chave_definida && !valor.empty()) {
+            documento = valor;
+            chave_definida = true;
+        } else if (argumento == "--format" && (valor == "csv" || valor == "json")) {
+            json = valor == "json";
+        } else {
+            exibir_uso(argv[0]);
+            return 2;
+        }
+    }
+    if (!chave_definida) {
+        exibir_uso(argv[0]);
+        return 2;
+    }
 
-void pausar() {
-    cout << "Pressione ENTER para continuar...";
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    Cliente c{};
+    ResultadoConsulta resultado = ResultadoConsulta::Ausente;
+    if (documento.size() < sizeof(c.documento)) {
+        resultado = consultar_arquivos(id, documento.c_str(), c);
+    }
+    if (resultado == ResultadoConsulta::Encontrado) {
+        imprimir_consulta(c, json);
+        return 0;
+    }
+    if (resultado == ResultadoConsulta::Ausente) {
+        cerr << "Cliente não encontrado." << endl;
+        return 1;
+    }
+    return 2;
 }
 
-void limpar_tela() {
-    #ifdef _WIN32
-    system("cls");
-    #else
-    system("clear");
-    #endif
+// Verifica os arquivos sem carregar a base; com --repair, regrava-a.
+// Retorna 0 sem problemas (ou reparada), 1 com problemas e 2 em erro.
+int comando_verificar(int argc, char *argv[], bool reparar) {
+    if (argc != 2) {
+        exibir_uso(argv[0]);
+        return 2;
+    }
+    Verificacao verificacao;
+    auto inicio = chrono::steady_clock::now();
+    if (!verificar_arquivos(verificacao)) {
+        liberar_verificacao(verificacao);
+        return 2;
+    }
+    chrono::duration<double> decorrido = chrono::steady_clock::now() - inicio;
+    exibir_relatorio_verificacao(verificacao, decorrido.count());
+    const bool com_problemas = total_de_problemas(verificacao.relatorio) > 0;
+    int codigo = com_problemas ? 1 : 0;
+    if (reparar && com_problemas) {
+        codigo = reparar_arquivos(verificacao) ? 0 : 2;
+    }
+    liberar_verificacao(verificacao);
+    return codigo;
 }
 
-void desenhar_banner(const string &titulo) {
-    limpar_tela();
-    cout << "==================================================" << endl;
-    cout << "  " << titulo << endl;
-    cout << "==================================================" << endl << endl;
-}
-
-void exibir_menu() {
-    desenhar_banner("Sistema de Gerenciamento de Clientes");
-    cout << "1 - Listar clientes" << endl;
-    cout << "2 - Inserir novo cliente" << endl;
-    cout << "3 - Atualizar cliente" << endl;
-    cout << "4 - Remover cliente" << endl;
-    cout << "5 - Buscar por ID (binária)" << endl;
-    cout << "6 - Buscar por nome (binária)" << endl;
-    cout << "7 - Mostrar trecho armazenado" << endl;
-    cout << "8 - Ordenar e salvar" << endl;
-    cout << "0 - Sair" << endl;
-}
-
-int main() {
+int executar_linha_de_comando(int argc, char *argv[]) {
+    const string comando = argv[1];
+    if (comando == "merge") {
+        return comando_merge(argc, argv);
+    }
+    if (comando == "export") {
+        return comando_export(argc, argv);
+    }
+    if (comando == "csv") {
+        return comando_csv(argc, argv);
+    }
+    if (comando == "query") {
+        return comando_query(argc, argv);
+    }
+    if (comando == "get") {
+        return comando_get(argc, argv);
+    }
+    if (comando == "--verify" || comando == "--repair") {
+        return comando_verificar(argc, argv, comando == "--repair");
+    }
+    exibir_uso(argv[0]);
+    return 2;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        return executar_linha_de_comando(argc, argv);
+    }
+
     BaseClientes base;
     if (!carregar_clientes(base)) {
         return 1;
@@ -893,7 +6462,7 @@ int main() {
 
     int opcao = -1;
     while (opcao != 0) {
-        exibir_menu();
+        exibir_menu(base);
         opcao = ler_inteiro("Escolha uma opção");
 
         switch (opcao) {
@@ -928,6 +6497,33 @@ int main() {
             case 8:
                 submenu_ordenacao(base);
                 break;
+            case 9:
+                buscar_por_trecho(base);
+                pausar();
+                break;
+            case 10:
+                mesclar_csv_interativo(base);
+                pausar();
+                break;
+            case 11:
+                exportar_interativo(base);
+                pausar();
+                break;
+            case 12:
+                submenu_ranking(base);
+                break;
+            case 13:
+                exportar_csv_completo(base);
+                pausar();
+                break;
+            case 14:
+                exibir_painel(base);
+                pausar();
+                break;
+            case 15:
+                consultar_interativo(base);
+                pausar();
+                break;
             case 0: {
                 bool entrada_valida = false;
                 while (!entrada_valida) {